@@ -0,0 +1,204 @@
+/***************************************
+Fenwick Tree (Binary Indexed Tree)
+
+add / sum in O(log N) with N + 1 elements and no lazy tags. use it
+instead of SegTree (segment-tree/segment_tree.hpp) when only sums are
+needed. the interface is 0-indexed and ranges are [l, r) as in SegTree.
+
+Fenwick<T>: point add, range sum
+- void add(int p, T x)
+- T    sum(int r)                 // of [0, r)
+- T    sum(int l, int r)          // of [l, r)
+- T    get(int p)
+- int  lower_bound(T w)
+  // the smallest p with sum(0, p + 1) >= w, N if there is none.
+  // the elements have to be non-negative. lower_bound(k + 1) is the k-th
+  // (0-indexed) element when the tree counts elements.
+
+RangeFenwick<T>: range add, range sum with two Fenwick trees
+  sum(0, r) = r * B1.sum(r) - B2.sum(r), and add(l, r, x) is
+  B1 += x at l, -x at r and B2 += x * l at l, -x * r at r.
+  the initial array is in B2 with the sign flipped.
+- void add(int l, int r, T x), add(int p, T x)
+- T    sum(int l, int r), get(int p)
+
+Fenwick2D<T>: point add, rectangle sum on H x W
+- void add(int y, int x, T v)
+- T    sum(int y1, int x1, int y2, int x2)   // of [y1, y2) x [x1, x2)
+
+building from an array is O(N): tree[i] is the sum of (i - (i & -i), i],
+i.e. the difference of two prefix sums. with num_threads > 1 the prefix
+sums are a parallel scan (each thread scans a block, then adds the sum
+of the blocks before it) and every tree[i] is set independently. an array
+shorter than parallel_grain per thread is built by the calling thread.
+***************************************/
+
+#ifndef GUARD_FENWICK_TREE
+#define GUARD_FENWICK_TREE
+
+#include <algorithm>
+#include <vector>
+#include <thread>
+
+template <typename T> class Fenwick{
+  int            N;
+  std::vector<T> tree;      // 1-indexed
+
+  enum { parallel_grain = 1 << 15 };
+
+  // f(t, begin, end) for the t-th of threads blocks of [begin, end)
+  template <typename Func> static void parallel_blocks(int threads, int begin, int end, Func f){
+    std::vector<std::thread> ts;
+    for(int t = 0; t < threads; t++){
+      int b = begin + (long long)(end - begin) * t / threads;
+      int e = begin + (long long)(end - begin) * (t + 1) / threads;
+      ts.emplace_back([t, b, e, &f](){ f(t, b, e); });
+    }
+    for(auto &t : ts) t.join();
+  }
+
+  template <typename Gen> void build(Gen &gen, int num_threads){
+    tree.assign(N + 1, 0);
+    int threads = std::min(num_threads, N / parallel_grain);
+    if(threads <= 1){
+      for(int i = 1; i <= N; i++) tree[i] += gen(i - 1);
+      for(int i = 1; i <= N; i++){
+        int j = i + (i & -i);
+        if(j <= N) tree[j] += tree[i];
+      }
+      return;
+    }
+    // pre[i] = gen(0) + ... + gen(i - 1)
+    std::vector<T> pre(N + 1, 0), block(threads, 0);
+    parallel_blocks(threads, 1, N + 1, [&pre, &block, &gen](int t, int b, int e){
+        T s = 0;
+        for(int i = b; i < e; i++) pre[i] = s += gen(i - 1);
+        block[t] = s;
+      });
+    for(int t = 1; t < threads; t++) block[t] += block[t - 1];
+    parallel_blocks(threads, 1, N + 1, [&pre, &block](int t, int b, int e){
+        if(t == 0) return;
+        for(int i = b; i < e; i++) pre[i] += block[t - 1];
+      });
+    parallel_blocks(threads, 1, N + 1, [this, &pre](int, int b, int e){
+        for(int i = b; i < e; i++) tree[i] = pre[i] - pre[i - (i & -i)];
+      });
+  }
+
+public:
+  Fenwick(int N = 0) : N(N), tree(N + 1, 0) {}
+
+  Fenwick(const std::vector<T> &A, int num_threads = std::thread::hardware_concurrency())
+    : N(A.size()) {
+    auto gen = [&A](int i){ return A[i]; };
+    build(gen, std::max(num_threads, 1));
+  }
+
+  // the element i is gen(i)
+  template <typename Gen>
+  Fenwick(int N, Gen gen, int num_threads = std::thread::hardware_concurrency())
+    : N(N) {
+    build(gen, std::max(num_threads, 1));
+  }
+
+  int length() const { return N; }
+
+  void add(int p, T x){
+    for(p++; p <= N; p += p & -p) tree[p] += x;
+  }
+
+  T sum(int r) const {
+    T s = 0;
+    for(; r > 0; r -= r & -r) s += tree[r];
+    return s;
+  }
+
+  T sum(int l, int r) const { return l < r ? sum(r) - sum(l) : 0; }
+  T get(int p) const { return sum(p, p + 1); }
+
+  int lower_bound(T w) const {
+    if(w <= 0) return 0;
+    int p = 0, step = 1;
+    while(step * 2 <= N) step *= 2;
+    // tree[p + step] is the sum of (p, p + step]
+    for(; step > 0; step /= 2){
+      if(p + step <= N && tree[p + step] < w){
+        p += step;
+        w -= tree[p];
+      }
+    }
+    return p;
+  }
+};
+
+template <typename T> class RangeFenwick{
+  Fenwick<T> b1, b2;
+
+public:
+  RangeFenwick(int N = 0) : b1(N), b2(N) {}
+
+  RangeFenwick(const std::vector<T> &A, int num_threads = std::thread::hardware_concurrency())
+    : b1(A.size()), b2(A.size(), [&A](int i){ return -A[i]; }, num_threads) {}
+
+  int length() const { return b1.length(); }
+
+  void add(int l, int r, T x){
+    if(l >= r) return;
+    b1.add(l, x);
+    b2.add(l, x * l);
+    if(r < length()){
+      b1.add(r, -x);
+      b2.add(r, -x * r);
+    }
+  }
+
+  void add(int p, T x){ b2.add(p, -x); }
+
+  T sum(int r) const { return b1.sum(r) * r - b2.sum(r); }
+  T sum(int l, int r) const { return l < r ? sum(r) - sum(l) : 0; }
+  T get(int p) const { return sum(p, p + 1); }
+};
+
+template <typename T> class Fenwick2D{
+  int            H, W;
+  std::vector<T> tree;      // (H + 1) x (W + 1), 1-indexed
+
+  T sum(int y, int x) const {
+    T s = 0;
+    for(int i = y; i > 0; i -= i & -i)
+      for(int j = x; j > 0; j -= j & -j) s += tree[i * (W + 1) + j];
+    return s;
+  }
+
+public:
+  Fenwick2D(int H, int W) : H(H), W(W), tree((H + 1) * (W + 1), 0) {}
+
+  // O(H W): the 1D build on each row, then on each column
+  Fenwick2D(const std::vector<std::vector<T> > &A)
+    : H(A.size()), W(A.empty() ? 0 : A[0].size()), tree((H + 1) * (W + 1), 0) {
+    for(int i = 1; i <= H; i++)
+      for(int j = 1; j <= W; j++) tree[i * (W + 1) + j] = A[i - 1][j - 1];
+    for(int i = 1; i <= H; i++)
+      for(int j = 1; j <= W; j++){
+        int k = j + (j & -j);
+        if(k <= W) tree[i * (W + 1) + k] += tree[i * (W + 1) + j];
+      }
+    for(int i = 1; i <= H; i++){
+      int k = i + (i & -i);
+      if(k > H) continue;
+      for(int j = 1; j <= W; j++) tree[k * (W + 1) + j] += tree[i * (W + 1) + j];
+    }
+  }
+
+  void add(int y, int x, T v){
+    for(int i = y + 1; i <= H; i += i & -i)
+      for(int j = x + 1; j <= W; j += j & -j) tree[i * (W + 1) + j] += v;
+  }
+
+  T sum(int y1, int x1, int y2, int x2) const {
+    if(y1 >= y2 || x1 >= x2) return 0;
+    return sum(y2, x2) - sum(y1, x2) - sum(y2, x1) + sum(y1, x1);
+  }
+};
+
+#endif
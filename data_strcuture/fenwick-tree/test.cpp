@@ -0,0 +1,202 @@
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <iostream>
+#include "fenwick_tree.hpp"
+#include "../segment-tree/segment_tree.hpp"
+using namespace std;
+
+
+typedef long long ll;
+
+vector<ll> random_array(size_t n){
+    vector<ll> array;
+    for (size_t i = 0; i < n; i++)
+        array.push_back(rand() - rand());
+    return array;
+}
+
+TEST(FENWICK_TEST, RANDOM){
+    const int N = 1000;
+    const int Q = 100000;
+    vector<ll> A = random_array(N);
+    Fenwick<ll> F(A);
+
+    for (int i = 0; i < Q; i++){
+        int l = rand() % N;
+        int r = rand() % N + 1;
+        if (l > r) swap(l, r);
+
+        if (rand() % 2){        // ADD
+            int v = rand() - rand();
+            A[l] += v;
+            F.add(l, v);
+        } else {                // SUM
+            ll s = 0;
+            for (int j = l; j < r; j++) s += A[j];
+            ASSERT_EQ(s, F.sum(l, r));
+        }
+    }
+    for (int i = 0; i < N; i++) ASSERT_EQ(A[i], F.get(i));
+}
+
+TEST(FENWICK_TEST, LOWER_BOUND){
+    for (int N : {1, 2, 7, 8, 9, 1000}){
+        vector<int> cnt(N, 0);
+        Fenwick<int> F(N);
+        for (int i = 0; i < 3 * N; i++){
+            int p = rand() % N;
+            cnt[p]++;
+            F.add(p, 1);
+
+            int w = rand() % (i + 3);
+            int expect = 0, s = 0;
+            while (expect < N && s + cnt[expect] < w) s += cnt[expect++];
+            if (w <= 0) expect = 0;
+            ASSERT_EQ(expect, F.lower_bound(w));
+        }
+    }
+}
+
+TEST(RANGE_FENWICK_TEST, RANDOM){
+    const int N = 1000;
+    const int Q = 100000;
+    vector<ll> A = random_array(N);
+    RangeFenwick<ll> F(A);
+
+    for (int i = 0; i < Q; i++){
+        int l = rand() % N;
+        int r = rand() % N + 1;
+        if (l > r) swap(l, r);
+
+        switch (rand() % 3){
+        case 0: {               // RANGE ADD
+            int v = rand() - rand();
+            for (int j = l; j < r; j++) A[j] += v;
+            F.add(l, r, v);
+            break;
+        }
+        case 1: {               // POINT ADD
+            int v = rand() - rand();
+            A[l] += v;
+            F.add(l, v);
+            break;
+        }
+        default: {              // SUM
+            ll s = 0;
+            for (int j = l; j < r; j++) s += A[j];
+            ASSERT_EQ(s, F.sum(l, r));
+        }
+        }
+    }
+    for (int i = 0; i < N; i++) ASSERT_EQ(A[i], F.get(i));
+}
+
+TEST(FENWICK_2D_TEST, RANDOM){
+    const int H = 37, W = 50;
+    const int Q = 20000;
+    vector<vector<ll> > A(H);
+    for (auto &row : A) row = random_array(W);
+    Fenwick2D<ll> F(A);
+
+    for (int i = 0; i < Q; i++){
+        int y1 = rand() % H, y2 = rand() % H + 1;
+        int x1 = rand() % W, x2 = rand() % W + 1;
+        if (y1 > y2) swap(y1, y2);
+        if (x1 > x2) swap(x1, x2);
+
+        if (rand() % 2){        // ADD
+            int v = rand() - rand();
+            A[y1][x1] += v;
+            F.add(y1, x1, v);
+        } else {                // SUM
+            ll s = 0;
+            for (int y = y1; y < y2; y++)
+                for (int x = x1; x < x2; x++) s += A[y][x];
+            ASSERT_EQ(s, F.sum(y1, x1, y2, x2));
+        }
+    }
+}
+
+TEST(BUILD_TEST, PARALLEL){
+    // large enough for 4 threads of parallel_grain elements
+    for (int N : {1 << 17, (1 << 17) + 12345}){
+        vector<ll> A = random_array(N);
+        Fenwick<ll> F1(A, 1), F4(A, 4);
+        Fenwick<ll> F(N);
+        for (int i = 0; i < N; i++) F.add(i, A[i]);
+        for (int i = 0; i < 1000; i++){
+            int l = rand() % N;
+            int r = rand() % N + 1;
+            if (l > r) swap(l, r);
+            ASSERT_EQ(F.sum(l, r), F1.sum(l, r));
+            ASSERT_EQ(F.sum(l, r), F4.sum(l, r));
+        }
+        RangeFenwick<ll> R(A, 4);
+        ASSERT_EQ(F.sum(0, N), R.sum(0, N));
+    }
+}
+
+TEST(FENWICK_TEST, BENCHMARK){
+    // build, point add + range sum and range add + range sum against SegTree
+    const int N = 1000000;
+    const int Q = 1000000;
+    vector<ll> A = random_array(N);
+    vector<pair<int, int> > qs(Q);
+    for (auto &q : qs){
+        q.first  = rand() % N;
+        q.second = rand() % N + 1;
+        if (q.first > q.second) swap(q.first, q.second);
+    }
+    auto sec = [](chrono::steady_clock::time_point a, chrono::steady_clock::time_point b){
+        return chrono::duration<double>(b - a).count();
+    };
+
+    SegTree<ll> T2(A, 1);
+    auto t0 = chrono::steady_clock::now();
+    SegTree<ll> T(A, 1);
+    auto t1 = chrono::steady_clock::now();
+    Fenwick<ll> F(A, 1);
+    RangeFenwick<ll> R(A, 1);
+    auto t2 = chrono::steady_clock::now();
+    cerr << "seconds to build (SegTree, Fenwick + RangeFenwick): "
+         << sec(t0, t1) << " " << sec(t1, t2) << endl;
+
+    ll check = 0;
+    t0 = chrono::steady_clock::now();
+    for (int i = 0; i < Q; i++){
+        if (i % 2) T.add(qs[i].first, qs[i].first + 1, i);
+        else       check += T.sum(qs[i].first, qs[i].second);
+    }
+    t1 = chrono::steady_clock::now();
+    for (int i = 0; i < Q; i++){
+        if (i % 2) F.add(qs[i].first, i);
+        else       check -= F.sum(qs[i].first, qs[i].second);
+    }
+    t2 = chrono::steady_clock::now();
+    ASSERT_EQ(check, 0);
+    cerr << "seconds for point add / sum (SegTree, Fenwick): "
+         << sec(t0, t1) << " " << sec(t1, t2) << endl;
+
+    t0 = chrono::steady_clock::now();
+    for (int i = 0; i < Q; i++){
+        if (i % 2) T2.add(qs[i].first, qs[i].second, i);
+        else       check += T2.sum(qs[i].first, qs[i].second);
+    }
+    t1 = chrono::steady_clock::now();
+    for (int i = 0; i < Q; i++){
+        if (i % 2) R.add(qs[i].first, qs[i].second, i);
+        else       check -= R.sum(qs[i].first, qs[i].second);
+    }
+    t2 = chrono::steady_clock::now();
+    ASSERT_EQ(check, 0);
+    cerr << "seconds for range add / sum (SegTree, RangeFenwick): "
+         << sec(t0, t1) << " " << sec(t1, t2) << endl;
+}
+
+int main(int argc, char **argv){
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
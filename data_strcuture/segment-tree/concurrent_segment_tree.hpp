@@ -0,0 +1,200 @@
+/***************************************
+Concurrent Segment Tree
+
+SegTree (sum / min / range add) shared by many threads: queries never
+write to the tree and never wait for a lock, and adds are applied in
+batches.
+
+- a range add is kept in the nodes it covers as a tag which is never
+  pushed down (as PersistentSegTree), so a query only reads: the tags of
+  the ancestors are added on the way down.
+- there are two copies of the tree (left-right). readers use the copy
+  published by the writer; a batch of adds is applied to the other copy,
+  which is then published, and after the readers of the old copy have
+  left, the batch is applied to it too.
+- a reader announces itself in one of two epochs (read_epoch), in a
+  counter picked by its thread id, each counter on its own cache line.
+  the writer flips the epoch and waits for the counters of an epoch to
+  drop to 0, so a reader never has to wait and readers of different
+  threads do not share a cache line in the common case.
+
+adds are queued and applied by publish(), or by add() itself when
+batch_size adds are queued (1 by default: every add is visible when it
+returns). queries see the adds published before them; a batch is seen
+entirely or not at all. adds and publish() take a mutex among writers.
+
+member method
+- void add(int l, int r, T x)      // queued
+- void publish()
+- T    sum(int l, int r) const
+- T    min(int l, int r) const, min(int l, int r, int &pos) const
+  // pos: the rightmost position of the minimum, as SegTree
+***************************************/
+
+#ifndef GUARD_CONCURRENT_SEGMENT_TREE
+#define GUARD_CONCURRENT_SEGMENT_TREE
+
+#include <algorithm>
+#include <vector>
+#include <limits>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <functional>
+
+template <typename T> class ConcurrentSegTree{
+  struct Copy{
+    std::vector<T>   sums, mins;   // of the subtree, with the own tag
+    std::vector<int> poss;         // the rightmost position of mins
+    std::vector<T>   tags;         // added to the whole subtree
+  };
+
+  struct Add{
+    int l, r;
+    T   x;
+  };
+
+  enum { stripes = 32 };
+  struct alignas(64) Counter{ std::atomic<int> n; };
+
+  int                N;
+  int                size;         // number of leaves, a power of two
+  Copy               copies[2];
+  std::atomic<int>   current;      // the copy for the readers
+  std::atomic<int>   read_epoch;
+  mutable Counter    readers[2][stripes];
+  std::mutex         writer;
+  std::vector<Add>   pending;
+
+  // the padding leaves are never covered by an add, so their maximum
+  // minimum never gets a tag
+  static void merge(Copy &c, int k, int len){
+    int a = 2 * k, b = 2 * k + 1;
+    c.sums[k] = c.sums[a] + c.sums[b] + c.tags[k] * len;
+    c.mins[k] = (c.mins[b] <= c.mins[a] ? c.mins[b] : c.mins[a]) + c.tags[k];
+    c.poss[k] = c.mins[b] <= c.mins[a] ? c.poss[b] : c.poss[a];
+  }
+
+  static void add(Copy &c, int a, int b, T x, int k, int l, int r){
+    if(b <= l || r <= a) return;
+    if(a <= l && r <= b){
+      c.tags[k] += x;
+      c.sums[k] += x * (r - l);
+      c.mins[k] += x;
+      return;
+    }
+    int m = (l + r) / 2;
+    add(c, a, b, x, 2 * k, l, m);
+    add(c, a, b, x, 2 * k + 1, m, r);
+    merge(c, k, r - l);
+  }
+
+  // acc: the tags of the ancestors
+  static T sum(const Copy &c, int a, int b, T acc, int k, int l, int r){
+    if(b <= l || r <= a) return 0;
+    if(a <= l && r <= b) return c.sums[k] + acc * (r - l);
+    int m = (l + r) / 2;
+    acc += c.tags[k];
+    return sum(c, a, b, acc, 2 * k, l, m) + sum(c, a, b, acc, 2 * k + 1, m, r);
+  }
+
+  // the minimum of [a, b) and [l, r) and its rightmost position to res / pos,
+  // if it is not greater than res (the right child is visited last)
+  static void min(const Copy &c, int a, int b, T acc, int k, int l, int r, T &res, int &pos){
+    if(b <= l || r <= a) return;
+    if(a <= l && r <= b){
+      if(c.mins[k] + acc <= res){ res = c.mins[k] + acc; pos = c.poss[k]; }
+      return;
+    }
+    int m = (l + r) / 2;
+    acc += c.tags[k];
+    min(c, a, b, acc, 2 * k, l, m, res, pos);
+    min(c, a, b, acc, 2 * k + 1, m, r, res, pos);
+  }
+
+  static int stripe(){
+    return std::hash<std::thread::id>()(std::this_thread::get_id()) % stripes;
+  }
+
+  void wait_readers(int epoch){
+    for(int s = 0; s < stripes; s++)
+      while(readers[epoch][s].n.load() != 0) std::this_thread::yield();
+  }
+
+  // run f(copy) on the published copy
+  template <typename Func> void read(Func f) const {
+    Counter *cnt = &readers[read_epoch.load()][stripe()];
+    cnt->n.fetch_add(1);
+    f(copies[current.load()]);
+    cnt->n.fetch_sub(1);
+  }
+
+  // the caller holds writer
+  void apply_pending(){
+    if(pending.empty()) return;
+    int back = 1 - current.load();
+    for(const Add &op : pending) add(copies[back], op.l, op.r, op.x, 1, 0, size);
+    current.store(back);
+    // the readers of the old copy announced themselves in the old epoch
+    // (or in the new one before the flip of current): wait for both
+    int epoch = read_epoch.load();
+    wait_readers(1 - epoch);
+    read_epoch.store(1 - epoch);
+    wait_readers(epoch);
+    for(const Add &op : pending) add(copies[1 - back], op.l, op.r, op.x, 1, 0, size);
+    pending.clear();
+  }
+
+public:
+  int batch_size;
+
+  ConcurrentSegTree(const std::vector<T> &A) : N(A.size()), current(0), read_epoch(0), batch_size(1){
+    size = 1;
+    while(size < N) size *= 2;
+    Copy &c = copies[0];
+    c.sums.assign(2 * size, 0);
+    c.mins.assign(2 * size, std::numeric_limits<T>::max());
+    c.poss.assign(2 * size, -1);
+    c.tags.assign(2 * size, 0);
+    for(int i = 0; i < N; i++){
+      c.sums[size + i] = c.mins[size + i] = A[i];
+      c.poss[size + i] = i;
+    }
+    for(int len = 2; len <= size; len *= 2)
+      for(int k = size / len; k < 2 * size / len; k++) merge(c, k, len);
+    copies[1] = c;
+    for(int e = 0; e < 2; e++)
+      for(int s = 0; s < stripes; s++) readers[e][s].n.store(0);
+  }
+
+  ConcurrentSegTree(size_t N) : ConcurrentSegTree(std::vector<T>(N, 0)) {}
+
+  void add(int l, int r, T x){
+    if(l >= r) return;
+    std::lock_guard<std::mutex> lock(writer);
+    Add op = {l, r, x};
+    pending.push_back(op);
+    if((int)pending.size() >= batch_size) apply_pending();
+  }
+
+  void publish(){
+    std::lock_guard<std::mutex> lock(writer);
+    apply_pending();
+  }
+
+  T sum(int l, int r) const {
+    T res = 0;
+    read([&](const Copy &c){ res = sum(c, l, r, 0, 1, 0, size); });
+    return res;
+  }
+
+  T min(int l, int r, int &pos) const {
+    T res = std::numeric_limits<T>::max();
+    pos = -1;
+    read([&](const Copy &c){ min(c, l, r, 0, 1, 0, size, res, pos); });
+    return res;
+  }
+  T min(int l, int r) const {int tmp; return min(l, r, tmp);}
+};
+
+#endif
@@ -0,0 +1,179 @@
+/***************************************
+Persistent Segment Tree
+
+SegTree (sum / min / range add) where every add makes a new version and
+the old versions stay readable.
+
+- an add copies the O(log N) nodes it visits (path copying); the other
+  nodes are shared between the versions.
+- an add on a whole node is kept in the node as a tag which is never
+  pushed down, so queries do not copy anything: the tags of the ancestors
+  are added on the way down.
+- nodes live in a pool of arrays indexed by 32-bit integers, with a
+  reference count (parents + versions). drop() releases a version, and the
+  nodes reachable only from it go to a free list reused by later adds.
+
+member method
+- int  add(int version, int l, int r, T x)  // new version: version + x on [l, r)
+- T    sum(int version, int l, int r)
+- T    min(int version, int l, int r)
+- void drop(int version)                    // the version can not be used after
+- int  num_versions(), size_t num_nodes()   // num_nodes: nodes in use
+version 0 is the initial array.
+***************************************/
+
+#ifndef GUARD_PERSISTENT_SEGMENT_TREE
+#define GUARD_PERSISTENT_SEGMENT_TREE
+
+#include <algorithm>
+#include <vector>
+#include <limits>
+#include <cassert>
+#include <cstdint>
+
+template <typename T> class PersistentSegTree{
+  enum : uint32_t { NIL = UINT32_MAX };
+
+  int                   N;
+  // the pool of nodes
+  std::vector<uint32_t> left, right;
+  std::vector<uint32_t> ref;           // parents and versions pointing here
+  std::vector<T>        sums, mins;    // of the subtree, with the own tag
+  std::vector<T>        tags;          // added to the whole subtree
+  std::vector<uint32_t> free_list;
+  std::vector<uint32_t> roots;         // NIL if dropped
+  std::vector<uint32_t> stack;
+
+  uint32_t alloc(){
+    uint32_t k;
+    if(!free_list.empty()){
+      k = free_list.back();
+      free_list.pop_back();
+    }else{
+      assert(left.size() < NIL);
+      k = left.size();
+      left.push_back(NIL); right.push_back(NIL); ref.push_back(0);
+      sums.push_back(0);   mins.push_back(0);    tags.push_back(0);
+    }
+    return k;
+  }
+
+  // a copy of k which shares its children
+  uint32_t clone(uint32_t k){
+    uint32_t c = alloc();
+    left[c] = left[k]; right[c] = right[k]; ref[c] = 0;
+    sums[c] = sums[k]; mins[c] = mins[k];   tags[c] = tags[k];
+    if(left[c] != NIL){
+      ref[left[c]]++;
+      ref[right[c]]++;
+    }
+    return c;
+  }
+
+  void release(uint32_t k){
+    if(--ref[k] > 0) return;
+    stack.push_back(k);
+    while(!stack.empty()){
+      uint32_t v = stack.back(); stack.pop_back();
+      free_list.push_back(v);
+      if(left[v] == NIL) continue;
+      if(--ref[left[v]]  == 0) stack.push_back(left[v]);
+      if(--ref[right[v]] == 0) stack.push_back(right[v]);
+    }
+  }
+
+  inline void merge(uint32_t k, int len){
+    sums[k] = sums[left[k]] + sums[right[k]] + tags[k] * len;
+    mins[k] = std::min(mins[left[k]], mins[right[k]]) + tags[k];
+  }
+
+  uint32_t build(const std::vector<T> &A, int l, int r){
+    uint32_t k = alloc();
+    if(r - l == 1){
+      sums[k] = mins[k] = A[l];
+    }else{
+      int m = (l + r) / 2;
+      uint32_t chl = build(A, l, m);
+      uint32_t chr = build(A, m, r);
+      left[k] = chl; right[k] = chr;
+      ref[chl] = ref[chr] = 1;
+      merge(k, r - l);
+    }
+    return k;
+  }
+
+  uint32_t add(uint32_t k, int a, int b, T x, int l, int r){
+    uint32_t c = clone(k);
+    if(a <= l && r <= b){
+      tags[c] += x;
+      sums[c] += x * (r - l);
+      mins[c] += x;
+      return c;
+    }
+    int m = (l + r) / 2;
+    if(a < m){
+      uint32_t chl = add(left[c], a, b, x, l, m);
+      release(left[c]);
+      left[c] = chl;
+      ref[chl]++;
+    }
+    if(m < b){
+      uint32_t chr = add(right[c], a, b, x, m, r);
+      release(right[c]);
+      right[c] = chr;
+      ref[chr]++;
+    }
+    merge(c, r - l);
+    return c;
+  }
+
+  // acc: the tags of the ancestors
+  T sum(uint32_t k, int a, int b, T acc, int l, int r) const {
+    if(b <= l || r <= a) return 0;
+    if(a <= l && r <= b) return sums[k] + acc * (r - l);
+    int m = (l + r) / 2;
+    acc += tags[k];
+    return sum(left[k], a, b, acc, l, m) + sum(right[k], a, b, acc, m, r);
+  }
+
+  T min(uint32_t k, int a, int b, T acc, int l, int r) const {
+    if(b <= l || r <= a) return std::numeric_limits<T>::max();
+    if(a <= l && r <= b) return mins[k] + acc;
+    int m = (l + r) / 2;
+    acc += tags[k];
+    return std::min(min(left[k], a, b, acc, l, m), min(right[k], a, b, acc, m, r));
+  }
+
+public:
+  PersistentSegTree(const std::vector<T> &A) : N(A.size()){
+    assert(N > 0);
+    uint32_t root = build(A, 0, N);
+    ref[root] = 1;
+    roots.push_back(root);
+  }
+
+  int add(int version, int l, int r, T x){
+    assert(roots[version] != NIL);
+    uint32_t root = roots[version];
+    if(l < r){
+      root = add(root, l, r, x, 0, N);
+    }
+    ref[root]++;
+    roots.push_back(root);
+    return roots.size() - 1;
+  }
+
+  T sum(int version, int l, int r) const {return sum(roots[version], l, r, 0, 0, N);}
+  T min(int version, int l, int r) const {return min(roots[version], l, r, 0, 0, N);}
+
+  void drop(int version){
+    if(roots[version] == NIL) return;
+    release(roots[version]);
+    roots[version] = NIL;
+  }
+
+  int    num_versions() const {return roots.size();}
+  size_t num_nodes()    const {return left.size() - free_list.size();}
+};
+
+#endif
@@ -10,6 +10,42 @@ verified at
  pku 3468 (only add and sum)
 
 kyuridenamidaさんの記事を参考にしてます。
+
+LazySegTree<M, A> is the generic version: M is a monoid and A is an action
+on it (range update). it is iterative and non-recursive; the leaves are
+[size, 2 * size) for the smallest power of two size >= N, and node k has
+the children 2k and 2k + 1. the values of the monoid and the pending
+actions are kept in separate arrays.
+
+ M: typedef value_type;
+    static value_type id();
+    static value_type op(value_type a, value_type b);    // associative
+ A: typedef value_type;            // comparable by ==
+    static value_type id();
+    static value_type compose(value_type f, value_type g); // f after g
+    static M::value_type apply(value_type f, M::value_type x, int len);
+                                     // f on a segment of len elements
+
+member method of LazySegTree
+- void set(int p, S x), S get(int p)
+- S    prod(int l, int r), all_prod()        // op of [l, r)
+- void prod_batch(const pair<int, int> *queries, size_t n, S *out)
+  // out[i] = prod(queries[i]). the queries are answered in the order of l
+  // and a node pushed down for the previous query is not visited again, so
+  // a batch touches the upper levels about once instead of once per query.
+- void apply(int p, F f), apply(int l, int r, F f)
+- void assign(int l, const S *values, int n)  // [l, l + n) = values
+- void assign(int l, int n, Gen gen)           // leaf l + i = gen(i)
+
+LazySegTree(N, gen) sets the leaf i to gen(i) without an intermediate
+array. the construction and assign() fill the leaves and then each level
+of the affected nodes in num_threads threads (a level with fewer than
+parallel_grain nodes is done by the calling thread).
+
+SegTree<T> is LazySegTree<SumMin<T>, RangeAdd<T> > with the old
+interface (min also returns the position of the minimum, the rightmost
+one on a tie as before), sum_batch / min_batch on top of prod_batch, a
+constructor from a pointer (no copy of the array) and assign.
 ***************************************/
 
 #ifndef GUARD_SEGMENT_TREE
@@ -18,127 +54,289 @@ kyuridenamidaさんの記事を参考にしてます。
 #include <algorithm>
 #include <vector>
 #include <limits>
+#include <thread>
 
-template <typename T> class SegTree{
-  struct node_t{
-    T   min;
-    T   sum;
-    T   add;
-    int pos;
-  };
-    
-  int                 N;
-  std::vector<T>      A;
-  std::vector<node_t> data;
-
-  inline void eval(int k, int l, int r){
-    if(data[k].add == 0) return;
-    
-    if(r - l > 1){
-      data[2 * k + 1].add += data[k].add;
-      data[2 * k + 2].add += data[k].add;
-    }
-    
-    data[k].sum += data[k].add * (r - l);
-    data[k].min += data[k].add;
-    data[k].add  = 0;
-  }
-  
-  inline void merge(int k){
-    int chl  = k * 2 + 1;
-    int chr  = k * 2 + 2;
-    T   lmin = data[chl].min;
-    T   rmin = data[chr].min;
-    data[k].sum = data[chl].sum + data[chr].sum;
-    data[k].min = std::min(lmin, rmin);
-    data[k].pos = lmin < rmin ? data[chl].pos : data[chr].pos;
-  }
-    
-  void build(int k, int l, int r){
-    if(r - l == 1){
-      data[k].min = A[l];
-      data[k].sum = A[l];
-      data[k].pos = l;
-      data[k].add = 0;
-    }else{
-      int m   = (l + r) / 2;
-      int chl = 2 * k + 1;
-      int chr = 2 * k + 2;
-      build(chl, l, m);
-      build(chr, m, r);
-      merge(k);
+template <typename M, typename A> class LazySegTree{
+  typedef typename M::value_type S;
+  typedef typename A::value_type F;
+
+  int            N;
+  int            size;              // number of leaves, a power of two
+  int            log;
+  std::vector<S> val;               // 2 * size
+  std::vector<F> lazy;              // size, only the inner nodes
+  std::vector<int> order;           // reused by prod_batch
+
+  inline void update(int k){ val[k] = M::op(val[2 * k], val[2 * k + 1]); }
+
+  inline void all_apply(int k, const F &f, int len){
+    val[k] = A::apply(f, val[k], len);
+    if(k < size) lazy[k] = A::compose(f, lazy[k]);
+  }
+
+  // node k has the height h (2^h leaves)
+  inline void push(int k, int h){
+    if(lazy[k] == A::id()) return;
+    all_apply(2 * k,     lazy[k], 1 << (h - 1));
+    all_apply(2 * k + 1, lazy[k], 1 << (h - 1));
+    lazy[k] = A::id();
+  }
+
+  // push the actions down to the boundary nodes of [l, r) (leaf indices)
+  inline void push_bounds(int l, int r){
+    for(int i = log; i >= 1; i--){
+      if(((l >> i) << i) != l) push(l >> i, i);
+      if(((r >> i) << i) != r) push((r - 1) >> i, i);
     }
   }
-  
-  void add(int a, int b, T x, int k, int l, int r){
-    eval(k, l, r);
-    if(b <= l || r <= a){
+
+  enum { parallel_grain = 1 << 15 };
+
+  // f(i) for i in [begin, end), split among the threads
+  template <typename Func> void parallel_for(int begin, int end, Func f){
+    int threads = std::min(num_threads, (end - begin) / parallel_grain);
+    if(threads <= 1){
+      for(int i = begin; i < end; i++) f(i);
       return;
-    }else if(a <= l && r <= b){
-      data[k].add += x;
-      eval(k, l, r);
-    }else{
-      int m   = (l + r) / 2;
-      int chl = k * 2 + 1;
-      int chr = k * 2 + 2;
-      add(a, b, x, chl, l, m);
-      add(a, b, x, chr, m, r);
-      merge(k);
     }
+    std::vector<std::thread> ts;
+    for(int t = 0; t < threads; t++){
+      int b = begin + (long long)(end - begin) * t / threads;
+      int e = begin + (long long)(end - begin) * (t + 1) / threads;
+      ts.emplace_back([b, e, &f](){ for(int i = b; i < e; i++) f(i); });
+    }
+    for(auto &t : ts) t.join();
   }
-  
-  T min(int a, int b, int &pos, int k, int l, int r){
-    eval(k, l, r);
-    if(b <= l || r <= a){
-      return std::numeric_limits<T>::max();
-    }else if(a <= l && r <= b){
-      pos = data[k].pos;
-      return data[k].min;
-    }else{
-      int m   = (l + r) / 2;
-      int chl = k * 2 + 1;
-      int chr = k * 2 + 2;
-      int lpos = -1, rpos = -1;
-      T lmin = min(a, b, lpos, chl, l, m);
-      T rmin = min(a, b, rpos, chr, m, r);
-      merge(k);
-      pos = lmin < rmin ? lpos : rpos;
-      return std::min(lmin, rmin);
+
+  // recompute the inner nodes over the leaves [l, r) level by level; their
+  // tags are dropped (the boundary nodes have been pushed before)
+  void rebuild(int l, int r){
+    for(int h = 1; h <= log; h++){
+      parallel_for((l + size) >> h, ((r - 1 + size) >> h) + 1, [this](int k){
+          update(k);
+          lazy[k] = A::id();
+        });
     }
   }
-  
-  T sum(int a, int b, int k, int l, int r){
-    eval(k, l, r);
-    if(b <= l || r <= a){
-      return 0;
-    }else if(a <= l && r <= b){
-      return data[k].sum;
-    }else{
-      int m   = (l + r) / 2;
-      int chl = k * 2 + 1;
-      int chr = k * 2 + 2;
-      T   vl  = sum(a, b, chl, l, m);
-      T   vr  = sum(a, b, chr, m, r);
-      merge(k);
-      return vl + vr;
+
+  void init(int n){
+    N    = n;
+    log  = 0;
+    while((1 << log) < N) log++;
+    size = 1 << log;
+    val .assign(2 * size, M::id());
+    lazy.assign(size, A::id());
+  }
+
+public:
+  int num_threads;
+
+  LazySegTree(int N = 0) : num_threads(1) { init(N); }
+
+  LazySegTree(const std::vector<S> &v,
+              int num_threads = std::thread::hardware_concurrency())
+    : num_threads(std::max(num_threads, 1)) {
+    init(v.size());
+    parallel_for(0, N, [this, &v](int i){ val[size + i] = v[i]; });
+    rebuild(0, N);
+  }
+
+  template <typename Gen>
+  LazySegTree(int N, Gen gen, int num_threads = std::thread::hardware_concurrency())
+    : num_threads(std::max(num_threads, 1)) {
+    init(N);
+    parallel_for(0, N, [this, &gen](int i){ val[size + i] = gen(i); });
+    rebuild(0, N);
+  }
+
+  int length() const { return N; }
+
+  void set(int p, const S &x){
+    p += size;
+    for(int i = log; i >= 1; i--) push(p >> i, i);
+    val[p] = x;
+    for(int i = 1; i <= log; i++) update(p >> i);
+  }
+
+  S get(int p){
+    p += size;
+    for(int i = log; i >= 1; i--) push(p >> i, i);
+    return val[p];
+  }
+
+  S prod(int l, int r){
+    if(l >= r) return M::id();
+    l += size;
+    r += size;
+    push_bounds(l, r);
+    S sml = M::id(), smr = M::id();
+    while(l < r){
+      if(l & 1) sml = M::op(sml, val[l++]);
+      if(r & 1) smr = M::op(val[--r], smr);
+      l >>= 1;
+      r >>= 1;
     }
+    return M::op(sml, smr);
   }
-  
+
+  S all_prod() const { return val[1]; }
+
+  // emit(i, prod(queries[i].first, queries[i].second)) for each query
+  template <typename Emit>
+  void prod_batch(const std::pair<int, int> *queries, size_t n, Emit emit){
+    order.resize(n);
+    for(size_t i = 0; i < n; i++) order[i] = i;
+    std::sort(order.begin(), order.end(), [queries](int a, int b){
+        return queries[a].first < queries[b].first;
+      });
+    // the nodes pushed by the previous query at each height have no tag
+    // (only pushes happen in between), so they are skipped
+    std::vector<int> last_l(log + 1, -1), last_r(log + 1, -1);
+    for(int id : order){
+      int l = queries[id].first, r = queries[id].second;
+      if(l >= r){
+        emit(id, M::id());
+        continue;
+      }
+      l += size;
+      r += size;
+      for(int i = log; i >= 1; i--){
+        if(((l >> i) << i) != l){
+          int k = l >> i;
+          if(k != last_l[i] && k != last_r[i]) push(k, i);
+          last_l[i] = k;
+        } else {
+          last_l[i] = -1;
+        }
+        if(((r >> i) << i) != r){
+          int k = (r - 1) >> i;
+          if(k != last_l[i] && k != last_r[i]) push(k, i);
+          last_r[i] = k;
+        } else {
+          last_r[i] = -1;
+        }
+      }
+      S sml = M::id(), smr = M::id();
+      while(l < r){
+        if(l & 1) sml = M::op(sml, val[l++]);
+        if(r & 1) smr = M::op(val[--r], smr);
+        l >>= 1;
+        r >>= 1;
+      }
+      emit(id, M::op(sml, smr));
+    }
+  }
+
+  void prod_batch(const std::pair<int, int> *queries, size_t n, S *out){
+    prod_batch(queries, n, [out](int i, const S &v){ out[i] = v; });
+  }
+
+  // the leaf l + i becomes gen(i) for i in [0, n)
+  template <typename Gen> void assign(int l, int n, Gen gen){
+    if(n <= 0) return;
+    push_bounds(l + size, l + n + size);
+    parallel_for(0, n, [this, l, &gen](int i){ val[size + l + i] = gen(i); });
+    rebuild(l, l + n);
+  }
+
+  void assign(int l, const S *values, int n){
+    assign(l, n, [values](int i){ return values[i]; });
+  }
+
+  void apply(int p, const F &f){
+    p += size;
+    for(int i = log; i >= 1; i--) push(p >> i, i);
+    val[p] = A::apply(f, val[p], 1);
+    for(int i = 1; i <= log; i++) update(p >> i);
+  }
+
+  void apply(int l, int r, const F &f){
+    if(l >= r) return;
+    l += size;
+    r += size;
+    push_bounds(l, r);
+    for(int a = l, b = r, len = 1; a < b; a >>= 1, b >>= 1, len <<= 1){
+      if(a & 1) all_apply(a++, f, len);
+      if(b & 1) all_apply(--b, f, len);
+    }
+    for(int i = 1; i <= log; i++){
+      if(((l >> i) << i) != l) update(l >> i);
+      if(((r >> i) << i) != r) update((r - 1) >> i);
+    }
+  }
+};
+
+// sum and minimum (with its rightmost position) of a range
+template <typename T> struct SumMin{
+  struct value_type{
+    T   sum;
+    T   min;
+    int pos;
+  };
+  static value_type id(){
+    value_type e = {0, std::numeric_limits<T>::max(), -1};
+    return e;
+  }
+  static value_type op(const value_type &a, const value_type &b){
+    value_type c = {a.sum + b.sum, a.min < b.min ? a.min : b.min,
+                    a.min < b.min ? a.pos : b.pos};
+    return c;
+  }
+};
+
+// add x to every element of a range
+template <typename T> struct RangeAdd{
+  typedef T value_type;
+  static T id(){ return 0; }
+  static T compose(T f, T g){ return f + g; }
+  static typename SumMin<T>::value_type apply(T f, typename SumMin<T>::value_type x, int len){
+    x.sum += f * len;
+    x.min += f;
+    return x;
+  }
+};
+
+template <typename T> class SegTree{
+  typedef typename SumMin<T>::value_type node_t;
+
+  LazySegTree<SumMin<T>, RangeAdd<T> > tree;
+
+  // the leaf of A[i] at the position offset + i
+  struct Leaf{
+    const T *A;
+    int      offset;
+    node_t operator()(int i) const {
+      T x = A == NULL ? 0 : A[i];
+      node_t v = {x, x, offset + i};
+      return v;
+    }
+  };
+
 public:
-  SegTree(size_t N) : N(N), A(std::vector<T>(N, 0)){
-    data.resize(4 * N);
-    build(0, 0, N);
-  }
-    
-  SegTree(const std::vector<T> &A) : N(A.size()), A(A){
-    data.resize(4 * N);
-    build(0, 0, N);
-  }
-    
-  void add(int l, int r, T x) {add(l, r, x, 0, 0, N);}
-  T min(int l, int r, int &pos){pos = -1; return min(l, r, pos, 0, 0, N);}
+  SegTree(size_t N, int num_threads = std::thread::hardware_concurrency())
+    : tree(N, Leaf{NULL, 0}, num_threads) {}
+
+  SegTree(const std::vector<T> &A, int num_threads = std::thread::hardware_concurrency())
+    : tree(A.size(), Leaf{A.data(), 0}, num_threads) {}
+
+  SegTree(const T *A, size_t N, int num_threads = std::thread::hardware_concurrency())
+    : tree(N, Leaf{A, 0}, num_threads) {}
+
+  // A[l + i] = values[i] for i in [0, n)
+  void assign(int l, const T *values, int n){tree.assign(l, n, Leaf{values, l});}
+
+  void add(int l, int r, T x) {tree.apply(l, r, x);}
+  T min(int l, int r, int &pos){node_t v = tree.prod(l, r); pos = v.pos; return v.min;}
   T min(int l, int r){int tmp;return min(l, r, tmp);}
-  T sum(int l, int r){return sum(l, r, 0, 0, N);}
+  T sum(int l, int r){return tree.prod(l, r).sum;}
+
+  // out[i] = sum(queries[i]) / min(queries[i])
+  void sum_batch(const std::pair<int, int> *queries, size_t n, T *out){
+    tree.prod_batch(queries, n, [out](int i, const node_t &v){ out[i] = v.sum; });
+  }
+  void min_batch(const std::pair<int, int> *queries, size_t n, T *out){
+    tree.prod_batch(queries, n, [out](int i, const node_t &v){ out[i] = v.min; });
+  }
 };
 
 #endif
@@ -0,0 +1,206 @@
+/***************************************
+Segment Tree Beats
+
+range chmin / chmax / add and range sum / max / min.
+updates are amortized O(log^2 N), queries are O(log N).
+
+each node keeps the largest and the second largest (strictly smaller)
+value with the number of the largest, and the same for the minimum.
+chmin(x) stops at a node where second max < x < max, because there only
+the largest values change (likewise chmax); otherwise it goes down.
+
+the layout is the same as LazySegTree (segment_tree.hpp): node k has the
+children 2k and 2k + 1, the leaves are [size, 2 * size), and each field
+is a separate array. the padding leaves beyond N are never updated.
+
+member method
+- void chmin(int l, int r, T x)   // a[i] = min(a[i], x) for i in [l, r)
+- void chmax(int l, int r, T x)   // a[i] = max(a[i], x)
+- void add  (int l, int r, T x)
+- T    sum(int l, int r), max(int l, int r), min(int l, int r)
+***************************************/
+
+#ifndef GUARD_SEGMENT_TREE_BEATS
+#define GUARD_SEGMENT_TREE_BEATS
+
+#include <algorithm>
+#include <vector>
+#include <limits>
+
+template <typename T> class SegTreeBeats{
+  int            N;
+  int            size;
+  std::vector<T> sum_;
+  std::vector<T> max1, max2, min1, min2;   // max2 < max1, min1 < min2
+  std::vector<int> maxc, minc;             // number of max1 / min1
+  std::vector<T> lazy;                     // add, only the inner nodes
+
+  static T lowest(){ return std::numeric_limits<T>::lowest(); }
+  static T highest(){ return std::numeric_limits<T>::max(); }
+
+  // the number of real (not padding) leaves of the node over [l, r)
+  inline int len(int l, int r) const { return std::max(0, std::min(r, N) - l); }
+
+  inline void update(int k){
+    int a = 2 * k, b = 2 * k + 1;
+    sum_[k] = sum_[a] + sum_[b];
+
+    if(max1[a] == max1[b]){
+      max1[k] = max1[a];
+      max2[k] = std::max(max2[a], max2[b]);
+      maxc[k] = maxc[a] + maxc[b];
+    }else if(max1[a] > max1[b]){
+      max1[k] = max1[a];
+      max2[k] = std::max(max2[a], max1[b]);
+      maxc[k] = maxc[a];
+    }else{
+      max1[k] = max1[b];
+      max2[k] = std::max(max1[a], max2[b]);
+      maxc[k] = maxc[b];
+    }
+
+    if(min1[a] == min1[b]){
+      min1[k] = min1[a];
+      min2[k] = std::min(min2[a], min2[b]);
+      minc[k] = minc[a] + minc[b];
+    }else if(min1[a] < min1[b]){
+      min1[k] = min1[a];
+      min2[k] = std::min(min2[a], min1[b]);
+      minc[k] = minc[a];
+    }else{
+      min1[k] = min1[b];
+      min2[k] = std::min(min1[a], min2[b]);
+      minc[k] = minc[b];
+    }
+  }
+
+  // the largest values (max2 < x < max1) become x
+  inline void update_max(int k, T x){
+    sum_[k] += (x - max1[k]) * maxc[k];
+    if(max1[k] == min1[k])      min1[k] = x;
+    else if(max1[k] == min2[k]) min2[k] = x;
+    max1[k] = x;
+  }
+
+  // the smallest values (min1 < x < min2) become x
+  inline void update_min(int k, T x){
+    sum_[k] += (x - min1[k]) * minc[k];
+    if(min1[k] == max1[k])      max1[k] = x;
+    else if(min1[k] == max2[k]) max2[k] = x;
+    min1[k] = x;
+  }
+
+  inline void update_add(int k, T x, int n){
+    sum_[k] += x * n;
+    max1[k] += x;
+    if(max2[k] != lowest()) max2[k] += x;
+    min1[k] += x;
+    if(min2[k] != highest()) min2[k] += x;
+    if(k < size) lazy[k] += x;
+  }
+
+  // a child only of padding leaves is left as it is
+  void push(int k, int l, int r){
+    int m = (l + r) / 2;
+    for(int c = 2 * k, cl = l, cr = m; c <= 2 * k + 1; c++, cl = m, cr = r){
+      if(cl >= N) break;
+      if(lazy[k] != 0) update_add(c, lazy[k], len(cl, cr));
+      if(max1[k] < max1[c]) update_max(c, max1[k]);
+      if(min1[k] > min1[c]) update_min(c, min1[k]);
+    }
+    lazy[k] = 0;
+  }
+
+  void chmin(int a, int b, T x, int k, int l, int r){
+    if(b <= l || r <= a || max1[k] <= x) return;
+    if(a <= l && r <= b && max2[k] < x){
+      update_max(k, x);
+      return;
+    }
+    push(k, l, r);
+    int m = (l + r) / 2;
+    chmin(a, b, x, 2 * k, l, m);
+    chmin(a, b, x, 2 * k + 1, m, r);
+    update(k);
+  }
+
+  void chmax(int a, int b, T x, int k, int l, int r){
+    if(b <= l || r <= a || min1[k] >= x) return;
+    if(a <= l && r <= b && min2[k] > x){
+      update_min(k, x);
+      return;
+    }
+    push(k, l, r);
+    int m = (l + r) / 2;
+    chmax(a, b, x, 2 * k, l, m);
+    chmax(a, b, x, 2 * k + 1, m, r);
+    update(k);
+  }
+
+  void add(int a, int b, T x, int k, int l, int r){
+    if(b <= l || r <= a) return;
+    if(a <= l && r <= b){
+      update_add(k, x, len(l, r));
+      return;
+    }
+    push(k, l, r);
+    int m = (l + r) / 2;
+    add(a, b, x, 2 * k, l, m);
+    add(a, b, x, 2 * k + 1, m, r);
+    update(k);
+  }
+
+  T sum(int a, int b, int k, int l, int r){
+    if(b <= l || r <= a) return 0;
+    if(a <= l && r <= b) return sum_[k];
+    push(k, l, r);
+    int m = (l + r) / 2;
+    return sum(a, b, 2 * k, l, m) + sum(a, b, 2 * k + 1, m, r);
+  }
+
+  T max(int a, int b, int k, int l, int r){
+    if(b <= l || r <= a) return lowest();
+    if(a <= l && r <= b) return max1[k];
+    push(k, l, r);
+    int m = (l + r) / 2;
+    return std::max(max(a, b, 2 * k, l, m), max(a, b, 2 * k + 1, m, r));
+  }
+
+  T min(int a, int b, int k, int l, int r){
+    if(b <= l || r <= a) return highest();
+    if(a <= l && r <= b) return min1[k];
+    push(k, l, r);
+    int m = (l + r) / 2;
+    return std::min(min(a, b, 2 * k, l, m), min(a, b, 2 * k + 1, m, r));
+  }
+
+public:
+  SegTreeBeats(const std::vector<T> &A) : N(A.size()){
+    size = 1;
+    while(size < N) size *= 2;
+    sum_.assign(2 * size, 0);
+    max1.assign(2 * size, lowest());
+    max2.assign(2 * size, lowest());
+    min1.assign(2 * size, highest());
+    min2.assign(2 * size, highest());
+    maxc.assign(2 * size, 0);
+    minc.assign(2 * size, 0);
+    lazy.assign(size, 0);
+    for(int i = 0; i < N; i++){
+      sum_[size + i] = max1[size + i] = min1[size + i] = A[i];
+      maxc[size + i] = minc[size + i] = 1;
+    }
+    for(int k = size - 1; k >= 1; k--) update(k);
+  }
+
+  SegTreeBeats(size_t N) : SegTreeBeats(std::vector<T>(N, 0)) {}
+
+  void chmin(int l, int r, T x){chmin(l, r, x, 1, 0, size);}
+  void chmax(int l, int r, T x){chmax(l, r, x, 1, 0, size);}
+  void add  (int l, int r, T x){add  (l, r, x, 1, 0, size);}
+  T    sum(int l, int r){return sum(l, r, 1, 0, size);}
+  T    max(int l, int r){return max(l, r, 1, 0, size);}
+  T    min(int l, int r){return min(l, r, 1, 0, size);}
+};
+
+#endif
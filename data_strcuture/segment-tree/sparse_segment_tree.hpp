@@ -0,0 +1,160 @@
+/***************************************
+Sparse (Dynamic) Segment Tree
+
+SegTree (sum / min / range add) over the indices [0, N) for N up to 2^63,
+without coordinate compression. every element is 0 at first.
+
+a node covers up to 2^63 elements, so for an integer T the sums are
+computed in uint64_t, i.e. modulo 2^64 (no signed overflow), and converted
+to T when returned. a sum is exact whenever it fits in T.
+
+- nodes are made only on the paths of the adds, so the memory is
+  O(number of adds * log N) whatever N is. a missing child is a subtree of
+  zeros.
+- an add on a whole node is kept in the node as a tag which is never
+  pushed down (as PersistentSegTree), so queries do not make nodes: the
+  tags of the ancestors are added on the way down.
+- nodes live in a pool of arrays indexed by 32-bit integers and are only
+  appended; clear() empties the tree and keeps the memory.
+
+member method
+- void     add(uint64_t l, uint64_t r, T x)   // of [l, r)
+- T        sum(uint64_t l, uint64_t r)
+- T        min(uint64_t l, uint64_t r), min(uint64_t l, uint64_t r, uint64_t &pos)
+  // pos: the rightmost position of the minimum, as SegTree
+- void     clear()
+- size_t   num_nodes()
+- uint64_t length()
+***************************************/
+
+#ifndef GUARD_SPARSE_SEGMENT_TREE
+#define GUARD_SPARSE_SEGMENT_TREE
+
+#include <algorithm>
+#include <vector>
+#include <limits>
+#include <cassert>
+#include <cstdint>
+#include <type_traits>
+
+template <typename T> class SparseSegTree{
+  enum : uint32_t { NIL = UINT32_MAX };
+  // the type of the sums
+  typedef typename std::conditional<std::is_integral<T>::value, uint64_t, T>::type U;
+
+  uint64_t              N;
+  // the pool of nodes, the root is 0
+  std::vector<uint32_t> left, right;
+  std::vector<U>        sums;          // of the subtree, with the own tag
+  std::vector<T>        mins;
+  std::vector<uint64_t> poss;          // the rightmost position of mins
+  std::vector<T>        tags;          // added to the whole subtree
+
+  // a node of zeros over [l, r)
+  uint32_t alloc(uint64_t r){
+    assert(left.size() < NIL);
+    uint32_t k = left.size();
+    left.push_back(NIL); right.push_back(NIL);
+    sums.push_back(0);   mins.push_back(0);    poss.push_back(r - 1); tags.push_back(0);
+    return k;
+  }
+
+  inline void merge(uint32_t k, uint64_t l, uint64_t m, uint64_t r){
+    U        sl = 0, sr = 0;
+    T        ml = 0, mr = 0;
+    uint64_t pl = m - 1, pr = r - 1;
+    if(left[k] != NIL){
+      sl = sums[left[k]]; ml = mins[left[k]]; pl = poss[left[k]];
+    }
+    if(right[k] != NIL){
+      sr = sums[right[k]]; mr = mins[right[k]]; pr = poss[right[k]];
+    }
+    sums[k] = sl + sr + (U)tags[k] * (U)(r - l);
+    mins[k] = (mr <= ml ? mr : ml) + tags[k];
+    poss[k] = mr <= ml ? pr : pl;
+  }
+
+  void add(uint32_t k, uint64_t a, uint64_t b, T x, uint64_t l, uint64_t r){
+    if(a <= l && r <= b){
+      tags[k] += x;
+      sums[k] += (U)x * (U)(r - l);
+      mins[k] += x;
+      return;
+    }
+    uint64_t m = l + (r - l) / 2;
+    if(a < m){
+      if(left[k] == NIL){
+        uint32_t c = alloc(m);
+        left[k] = c;
+      }
+      add(left[k], a, b, x, l, m);
+    }
+    if(m < b){
+      if(right[k] == NIL){
+        uint32_t c = alloc(r);
+        right[k] = c;
+      }
+      add(right[k], a, b, x, m, r);
+    }
+    merge(k, l, m, r);
+  }
+
+  // acc: the tags of the ancestors
+  U sum(uint32_t k, uint64_t a, uint64_t b, U acc, uint64_t l, uint64_t r) const {
+    if(b <= l || r <= a) return 0;
+    if(k == NIL) return acc * (U)(std::min(b, r) - std::max(a, l));
+    if(a <= l && r <= b) return sums[k] + acc * (U)(r - l);
+    uint64_t m = l + (r - l) / 2;
+    acc += (U)tags[k];
+    return sum(left[k], a, b, acc, l, m) + sum(right[k], a, b, acc, m, r);
+  }
+
+  // the minimum of [a, b) and [l, r) and its rightmost position to res / pos,
+  // if it is not greater than res (the right side is visited last)
+  void min(uint32_t k, uint64_t a, uint64_t b, T acc, uint64_t l, uint64_t r,
+           T &res, uint64_t &pos) const {
+    if(b <= l || r <= a) return;
+    if(k == NIL){
+      if(acc <= res){ res = acc; pos = std::min(b, r) - 1; }
+      return;
+    }
+    if(a <= l && r <= b){
+      if(mins[k] + acc <= res){ res = mins[k] + acc; pos = poss[k]; }
+      return;
+    }
+    uint64_t m = l + (r - l) / 2;
+    acc += tags[k];
+    min(left[k],  a, b, acc, l, m, res, pos);
+    min(right[k], a, b, acc, m, r, res, pos);
+  }
+
+public:
+  SparseSegTree(uint64_t N = (uint64_t)1 << 63) : N(N){
+    assert(N > 0);
+    clear();
+  }
+
+  void clear(){
+    left.clear(); right.clear(); sums.clear(); mins.clear(); poss.clear(); tags.clear();
+    alloc(N);
+  }
+
+  void add(uint64_t l, uint64_t r, T x){
+    if(l < r) add(0, l, r, x, 0, N);
+  }
+
+  T sum(uint64_t l, uint64_t r) const {return (T)sum(0, l, r, 0, 0, N);}
+
+  T min(uint64_t l, uint64_t r, uint64_t &pos) const {
+    T res = std::numeric_limits<T>::max();
+    pos = l;
+    min(0, l, r, 0, 0, N, res, pos);
+    return res;
+  }
+  T min(uint64_t l, uint64_t r) const {uint64_t tmp; return min(l, r, tmp);}
+
+  size_t   num_nodes() const {return left.size();}
+  uint64_t length()    const {return N;}
+};
+
+#endif
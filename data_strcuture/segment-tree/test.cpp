@@ -2,7 +2,19 @@
 #include <string>
 #include <cstdlib>
 #include <vector>
+#include <limits>
+#include <thread>
+#include <chrono>
+#include <iostream>
+#include <atomic>
+#include <random>
+#include <mutex>
 #include "segment_tree.hpp"
+#include "persistent_segment_tree.hpp"
+#include "segment_tree_beats.hpp"
+#include "wide_segment_tree.hpp"
+#include "sparse_segment_tree.hpp"
+#include "concurrent_segment_tree.hpp"
 using namespace std;
 
 
@@ -29,11 +41,11 @@ TEST(ADD_SUM_TEST, RANDOM){
         if (rand() % 2){        // ADD
             int v = rand() - rand();
             for (int j = l; j < r; j++) A[j] += v;
-            T.Add(l, r, v);
+            T.add(l, r, v);
         } else {                // SUM
             ll sum = 0;
             for (int j = l; j < r; j++) sum += A[j];
-            ASSERT_EQ(sum, T.Sum(l, r));
+            ASSERT_EQ(sum, T.sum(l, r));
         }
     }
 }
@@ -52,18 +64,29 @@ TEST(ADD_MIN_TEST, RANDOM){
         if (rand() % 2){        // ADD
             int v = rand() - rand();
             for (int j = l; j < r; j++) A[j] += v;
-            T.Add(l, r, v);
-            // for (int j = l; j < r; j++) ASSERT_EQ(T.Sum(j, j + 1), A[j]);
+            T.add(l, r, v);
+            // for (int j = l; j < r; j++) ASSERT_EQ(T.sum(j, j + 1), A[j]);
         } else if (l != r){                // SUM
             ll  m = 1e12;
             int pos;
             for (int j = l; j < r; j++) m = min(m, A[j]);
-            ASSERT_EQ(m, T.Min(l, r, pos));
+            ASSERT_EQ(m, T.min(l, r, pos));
             ASSERT_EQ(m, A[pos]);
         }
     }
 }
 
+TEST(ADD_MIN_TEST, TIE){
+    // the rightmost position of the minimum
+    SegTree<ll> T(vector<ll>(10, 5));
+    int pos;
+    ASSERT_EQ(5, T.min(2, 7, pos));
+    ASSERT_EQ(6, pos);
+    T.add(3, 5, -1);
+    ASSERT_EQ(4, T.min(0, 10, pos));
+    ASSERT_EQ(4, pos);
+}
+
 TEST(ADD_SUM_MIN_TEST, RANDOM){
     const int N = 10000;
     const int Q = 100000;
@@ -80,22 +103,678 @@ TEST(ADD_SUM_MIN_TEST, RANDOM){
         if (t == 0){        // ADD
             int v = rand() - rand();
             for (int j = l; j < r; j++) A[j] += v;
-            T.Add(l, r, v);
-            // for (int j = l; j < r; j++) ASSERT_EQ(T.Sum(j, j + 1), A[j]);
+            T.add(l, r, v);
+            // for (int j = l; j < r; j++) ASSERT_EQ(T.sum(j, j + 1), A[j]);
         } else if (t == 1){
             ll sum = 0;
             for (int j = l; j < r; j++) sum += A[j];
-            ASSERT_EQ(sum, T.Sum(l, r));
+            ASSERT_EQ(sum, T.sum(l, r));
         } else if (l != r){                
             ll  m = 1e12;
             int pos;
             for (int j = l; j < r; j++) m = min(m, A[j]);
-            ASSERT_EQ(m, T.Min(l, r, pos));
+            ASSERT_EQ(m, T.min(l, r, pos));
             ASSERT_EQ(m, A[pos]);
         }
     }
 }
 
+// x -> a * x + b on the sums modulo P (the actions do not commute)
+const ll P = 998244353;
+
+struct ModSum{
+    typedef ll value_type;
+    static ll id(){ return 0; }
+    static ll op(ll a, ll b){ return (a + b) % P; }
+};
+
+struct Affine{
+    typedef pair<ll, ll> value_type;
+    static value_type id(){ return make_pair(1, 0); }
+    static value_type compose(value_type f, value_type g){
+        return make_pair(f.first * g.first % P, (f.first * g.second + f.second) % P);
+    }
+    static ll apply(value_type f, ll x, int len){ return (f.first * x + f.second * len) % P; }
+};
+
+TEST(LAZY_SEGTREE_TEST, AFFINE){
+    const int N = 1000;
+    const int Q = 100000;
+    vector<ll> A(N);
+    for (auto &a : A) a = rand() % P;
+    LazySegTree<ModSum, Affine> T(A);
+
+    for (int i = 0; i < Q; i++){
+        int l = rand() % N;
+        int r = rand() % N + 1;
+        if (l > r) swap(l, r);
+        int t = rand() % 4;
+        if (t == 0){
+            Affine::value_type f(rand() % P, rand() % P);
+            for (int j = l; j < r; j++) A[j] = (f.first * A[j] + f.second) % P;
+            T.apply(l, r, f);
+        } else if (t == 1){
+            ll x = rand() % P;
+            A[l] = x;
+            T.set(l, x);
+        } else if (t == 2){
+            ASSERT_EQ(A[l], T.get(l));
+        } else {
+            ll sum = 0;
+            for (int j = l; j < r; j++) sum = (sum + A[j]) % P;
+            ASSERT_EQ(sum, T.prod(l, r));
+        }
+    }
+}
+
+TEST(BATCH_TEST, RANDOM){
+    const int N = 5000;
+    vector<ll> A = random_array(N);
+    SegTree<ll> T(A);
+    for (int round = 0; round < 200; round++){
+        for (int i = rand() % 20; i > 0; i--){
+            int l = rand() % N, r = rand() % N + 1;
+            if (l > r) swap(l, r);
+            int v = rand() - rand();
+            for (int j = l; j < r; j++) A[j] += v;
+            T.add(l, r, v);
+        }
+        vector<pair<int, int> > qs(rand() % 500);
+        for (auto &q : qs){
+            q.first  = rand() % N;
+            q.second = rand() % N + 1;
+            if (q.first > q.second) swap(q.first, q.second);
+        }
+        vector<ll> sums(qs.size()), mins(qs.size());
+        T.sum_batch(qs.data(), qs.size(), sums.data());
+        T.min_batch(qs.data(), qs.size(), mins.data());
+        for (size_t i = 0; i < qs.size(); i++){
+            ll sum = 0, m = numeric_limits<ll>::max();
+            for (int j = qs[i].first; j < qs[i].second; j++){
+                sum += A[j];
+                m = min(m, A[j]);
+            }
+            ASSERT_EQ(sum, sums[i]);
+            ASSERT_EQ(m, mins[i]);
+        }
+    }
+}
+
+TEST(BATCH_TEST, BENCHMARK){
+    // batches of 4096 sum queries after each range add
+    const int N = 1000000;
+    const int B = 4096;
+    SegTree<ll> T(random_array(N));
+    vector<pair<int, int> > qs(B);
+    vector<ll> out(B);
+    double single = 0, batch = 0;
+    ll check = 0;
+    for (int round = 0; round < 200; round++){
+        int l = rand() % N, r = rand() % N + 1;
+        if (l > r) swap(l, r);
+        T.add(l, r, round % 7 - 3);
+        for (auto &q : qs){
+            q.first  = rand() % N;
+            q.second = rand() % N + 1;
+            if (q.first > q.second) swap(q.first, q.second);
+        }
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < B; i++) check += T.sum(qs[i].first, qs[i].second);
+        auto mid = chrono::steady_clock::now();
+        T.sum_batch(qs.data(), B, out.data());
+        auto end = chrono::steady_clock::now();
+        for (int i = 0; i < B; i++) check -= out[i];
+        single += chrono::duration<double>(mid - start).count();
+        batch  += chrono::duration<double>(end - mid).count();
+    }
+    ASSERT_EQ(check, 0);
+    cerr << "seconds (single, batch): " << single << " " << batch << endl;
+}
+
+TEST(BUILD_TEST, PARALLEL){
+    // built by 4 threads (parallel_grain is 2^15 nodes per thread)
+    const int N = 300000;
+    vector<ll> A = random_array(N);
+    SegTree<ll> T(A.data(), N, 4);
+    for (int i = 0; i < 1000; i++){
+        int l = rand() % N, r = rand() % N + 1;
+        if (l > r) swap(l, r);
+        int t = rand() % 3;
+        if (t == 0){
+            int v = rand() - rand();
+            for (int j = l; j < r; j++) A[j] += v;
+            T.add(l, r, v);
+        } else if (t == 1){
+            vector<ll> values = random_array(r - l);
+            copy(values.begin(), values.end(), A.begin() + l);
+            T.assign(l, values.data(), r - l);
+        } else {
+            ll sum = 0, m = numeric_limits<ll>::max();
+            for (int j = l; j < r; j++){
+                sum += A[j];
+                m = min(m, A[j]);
+            }
+            int pos;
+            ASSERT_EQ(sum, T.sum(l, r));
+            ASSERT_EQ(m, T.min(l, r, pos));
+            if (l < r){
+                ASSERT_EQ(m, A[pos]);
+            }
+        }
+    }
+}
+
+TEST(BUILD_TEST, BENCHMARK){
+    const int N = 10000000;
+    vector<ll> A = random_array(N);
+    int threads = max(1u, thread::hardware_concurrency());
+    auto start = chrono::steady_clock::now();
+    SegTree<ll> T1(A, 1);
+    auto mid = chrono::steady_clock::now();
+    SegTree<ll> T2(A, threads);
+    auto end = chrono::steady_clock::now();
+    ASSERT_EQ(T1.sum(0, N), T2.sum(0, N));
+    cerr << "seconds to build 10^7 (1 thread, " << threads << " threads): "
+         << chrono::duration<double>(mid - start).count() << " "
+         << chrono::duration<double>(end - mid).count() << endl;
+}
+
+TEST(PERSISTENT_TEST, RANDOM){
+    const int N = 1000;
+    const int Q = 20000;
+    vector<vector<ll> > versions(1, random_array(N));
+    vector<bool> dropped(1, false);
+    PersistentSegTree<ll> T(versions[0]);
+
+    for (int i = 0; i < Q; i++){
+        int v = rand() % versions.size();
+        if (dropped[v]) continue;
+        int l = rand() % N;
+        int r = rand() % N + 1;
+        if (l > r) swap(l, r);
+        int t = rand() % 4;
+        if (t == 0){
+            int x = rand() - rand();
+            vector<ll> A = versions[v];
+            for (int j = l; j < r; j++) A[j] += x;
+            ASSERT_EQ(T.add(v, l, r, x), (int)versions.size());
+            versions.push_back(A);
+            dropped.push_back(false);
+        } else if (t == 1){
+            ll sum = 0;
+            for (int j = l; j < r; j++) sum += versions[v][j];
+            ASSERT_EQ(sum, T.sum(v, l, r));
+        } else if (t == 2){
+            ll m = numeric_limits<ll>::max();
+            for (int j = l; j < r; j++) m = min(m, versions[v][j]);
+            ASSERT_EQ(m, T.min(v, l, r));
+        } else if (rand() % 4 == 0 && v + 1 < (int)versions.size()){
+            T.drop(v);
+            dropped[v] = true;
+        }
+    }
+
+    // only the newest version remains: a complete tree of 2N - 1 nodes
+    size_t before = T.num_nodes();
+    for (int v = 0; v + 1 < T.num_versions(); v++) T.drop(v);
+    ASSERT_EQ(T.num_nodes(), (size_t)(2 * N - 1));
+    ASSERT_LT(T.num_nodes(), before);
+    ll sum = 0;
+    for (ll a : versions.back()) sum += a;
+    ASSERT_EQ(sum, T.sum(T.num_versions() - 1, 0, N));
+
+    // the freed nodes are reused
+    size_t pool = T.num_nodes();
+    for (int i = 0; i < 100; i++){
+        int v = T.add(T.num_versions() - 1, rand() % N, N, 1);
+        T.drop(v - 1);
+    }
+    ASSERT_EQ(T.num_nodes(), pool);
+}
+
+TEST(BEATS_TEST, RANDOM){
+    // differential test against an array, with small values so that many
+    // elements share the maximum / minimum
+    for (int N : {1, 2, 3, 17, 100, 1000}){
+        vector<ll> A(N);
+        for (auto &a : A) a = rand() % 21 - 10;
+        SegTreeBeats<ll> T(A);
+        for (int i = 0; i < 20000; i++){
+            int l = rand() % N;
+            int r = rand() % N + 1;
+            if (l > r) swap(l, r);
+            ll x = rand() % 21 - 10;
+            switch (rand() % 6){
+            case 0:
+                for (int j = l; j < r; j++) A[j] = min(A[j], x);
+                T.chmin(l, r, x);
+                break;
+            case 1:
+                for (int j = l; j < r; j++) A[j] = max(A[j], x);
+                T.chmax(l, r, x);
+                break;
+            case 2:
+                for (int j = l; j < r; j++) A[j] += x;
+                T.add(l, r, x);
+                break;
+            case 3: {
+                ll sum = 0;
+                for (int j = l; j < r; j++) sum += A[j];
+                ASSERT_EQ(sum, T.sum(l, r));
+                break;
+            }
+            case 4: {
+                ll m = numeric_limits<ll>::lowest();
+                for (int j = l; j < r; j++) m = max(m, A[j]);
+                ASSERT_EQ(m, T.max(l, r));
+                break;
+            }
+            default: {
+                ll m = numeric_limits<ll>::max();
+                for (int j = l; j < r; j++) m = min(m, A[j]);
+                ASSERT_EQ(m, T.min(l, r));
+            }
+            }
+        }
+    }
+}
+
+template <typename T> void wide_random_test(int N){
+    vector<T> A(N);
+    for (auto &a : A) a = rand() % 2001 - 1000;
+    WideSegTree<T> W(A);
+    for (int i = 0; i < 20000; i++){
+        int l = rand() % N;
+        int r = rand() % N + 1;
+        if (l > r) swap(l, r);
+        int t = rand() % 3;
+        if (t == 0){
+            T x = rand() % 2001 - 1000;
+            A[l] += x;
+            W.add(l, x);
+        } else if (t == 1){
+            T sum = 0;
+            for (int j = l; j < r; j++) sum += A[j];
+            ASSERT_EQ(sum, W.sum(l, r));
+        } else {
+            T m = numeric_limits<T>::max();
+            for (int j = l; j < r; j++) m = min(m, A[j]);
+            ASSERT_EQ(m, W.min(l, r));
+        }
+    }
+}
+
+TEST(WIDE_TEST, RANDOM){
+    for (int N : {1, 15, 16, 17, 256, 257, 5000}){
+        wide_random_test<int>(N);
+        wide_random_test<ll>(N);
+        wide_random_test<double>(N);         // the scalar kernels
+    }
+}
+
+TEST(WIDE_TEST, COPY){
+    // a copy has its own pool, realigned
+    for (int N : {1, 17, 5000}){
+        vector<ll> A = random_array(N);
+        WideSegTree<ll> W(A), C(W), D(1);
+        D = W;
+        for (int i = 0; i < N; i++) W.add(i, 1);
+        for (int i = 0; i < 1000; i++){
+            int l = rand() % N;
+            int r = rand() % N + 1;
+            if (l > r) swap(l, r);
+            ll sum = 0, m = numeric_limits<ll>::max();
+            for (int j = l; j < r; j++){
+                sum += A[j];
+                m = min(m, A[j]);
+            }
+            ASSERT_EQ(sum, C.sum(l, r));
+            ASSERT_EQ(m, C.min(l, r));
+            ASSERT_EQ(sum, D.sum(l, r));
+            ASSERT_EQ(m, D.min(l, r));
+            ASSERT_EQ(sum + (r - l), W.sum(l, r));
+        }
+    }
+}
+
+TEST(WIDE_TEST, BENCHMARK){
+    // random range sum / min queries against SegTree. the SIMD kernels are
+    // only compiled in by make test-native
+#if defined(__AVX2__)
+    const char *kernel = "AVX2";
+#else
+    const char *kernel = "scalar";          // SSE4.1 has no 64-bit kernel
+#endif
+    const int Q = 1000000;
+    for (int N : {1000000, 10000000}){
+        vector<ll> A = random_array(N);
+        SegTree<ll>     T(A);
+        WideSegTree<ll> W(A);
+        vector<pair<int, int> > qs(Q);
+        for (auto &q : qs){
+            q.first  = rand() % N;
+            q.second = rand() % N + 1;
+            if (q.first > q.second) swap(q.first, q.second);
+        }
+        ll check = 0;
+        auto t0 = chrono::steady_clock::now();
+        for (auto &q : qs) check += T.sum(q.first, q.second);
+        auto t1 = chrono::steady_clock::now();
+        for (auto &q : qs) check -= W.sum(q.first, q.second);
+        auto t2 = chrono::steady_clock::now();
+        for (auto &q : qs) check += T.min(q.first, q.second);
+        auto t3 = chrono::steady_clock::now();
+        for (auto &q : qs) check -= W.min(q.first, q.second);
+        auto t4 = chrono::steady_clock::now();
+        ASSERT_EQ(check, 0);
+        auto ns = [Q](chrono::steady_clock::time_point a, chrono::steady_clock::time_point b){
+            return chrono::duration<double>(b - a).count() * 1e9 / Q;
+        };
+        cerr << "N = " << N << ", " << kernel << " kernel, ns per query (SegTree sum, wide sum, SegTree min, wide min): "
+             << ns(t0, t1) << " " << ns(t1, t2) << " " << ns(t2, t3) << " " << ns(t3, t4) << endl;
+    }
+}
+
+TEST(SPARSE_TEST, RANDOM){
+    // a small domain against an array
+    const int N = 1000;
+    const int Q = 100000;
+    vector<ll> A(N, 0);
+    SparseSegTree<ll> T(N);
+
+    for (int i = 0; i < Q; i++){
+        int l = rand() % N;
+        int r = rand() % N + 1;
+        if (l > r) swap(l, r);
+        int t = rand() % 3;
+        if (t == 0){
+            int x = rand() - rand();
+            for (int j = l; j < r; j++) A[j] += x;
+            T.add(l, r, x);
+        } else if (t == 1){
+            ll sum = 0;
+            for (int j = l; j < r; j++) sum += A[j];
+            ASSERT_EQ(sum, T.sum(l, r));
+        } else if (l < r){
+            int p = l;
+            for (int j = l; j < r; j++) if (A[j] <= A[p]) p = j;
+            uint64_t pos;
+            ASSERT_EQ(A[p], T.min(l, r, pos));
+            ASSERT_EQ((uint64_t)p, pos);
+        }
+    }
+}
+
+TEST(SPARSE_TEST, WIDE_DOMAIN){
+    // [0, 2^63) cut at 64 random points; the adds cover whole pieces, so
+    // every piece has one value
+    const uint64_t N = (uint64_t)1 << 63;
+    const int Q = 2000;
+    vector<uint64_t> cut = {0, N};
+    for (int i = 0; i < 64; i++) cut.push_back(((uint64_t)rand() << 32 ^ rand()) % N);
+    sort(cut.begin(), cut.end());
+    cut.erase(unique(cut.begin(), cut.end()), cut.end());
+    int P = cut.size() - 1;
+    vector<ll> A(P, 0);
+    SparseSegTree<ll> T;
+
+    for (int i = 0; i < Q; i++){
+        int l = rand() % P;
+        int r = rand() % P + 1;
+        if (l > r) swap(l, r);
+        if (rand() % 2){
+            int x = rand() % 201 - 100;
+            for (int j = l; j < r; j++) A[j] += x;
+            T.add(cut[l], cut[r], x);
+        } else if (l < r){
+            int p = l;
+            for (int j = l; j < r; j++) if (A[j] <= A[p]) p = j;
+            uint64_t pos;
+            ASSERT_EQ(A[p], T.min(cut[l], cut[r], pos));
+            ASSERT_EQ(cut[p + 1] - 1, pos);
+            uint64_t len = min<uint64_t>(1000, cut[p + 1] - cut[p]);
+            ASSERT_EQ(A[p] * (ll)len, T.sum(cut[p], cut[p] + len));
+        }
+    }
+    // the nodes are only on the paths of the adds
+    ASSERT_LE(T.num_nodes(), (size_t)(1 + Q * 2 * 63));
+
+    // a sum over 2^63 elements is modulo 2^64
+    T.clear();
+    T.add(0, N, 1);
+    T.add(N / 2, N / 2 + 10, -3);
+    ASSERT_EQ(N - 30, (uint64_t)T.sum(0, N));
+    ASSERT_EQ(-2, T.min(0, N));
+    T.clear();
+    ASSERT_EQ(T.num_nodes(), (size_t)1);
+    ASSERT_EQ(0, T.min(0, N));
+}
+
+TEST(SPARSE_TEST, TIE){
+    // the rightmost position of the minimum, as SegTree
+    const uint64_t N = (uint64_t)1 << 40;
+    SparseSegTree<ll> T(N);
+    uint64_t pos;
+    ASSERT_EQ(0, T.min(2, 7, pos));
+    ASSERT_EQ((uint64_t)6, pos);
+    ASSERT_EQ(0, T.min(0, N, pos));
+    ASSERT_EQ(N - 1, pos);
+    T.add(3, 5, -1);
+    ASSERT_EQ(-1, T.min(0, N, pos));
+    ASSERT_EQ((uint64_t)4, pos);
+    T.add(N - 10, N - 5, -1);
+    ASSERT_EQ(-1, T.min(0, N, pos));
+    ASSERT_EQ(N - 6, pos);
+    ASSERT_EQ(-1, T.min(0, N - 6, pos));
+    ASSERT_EQ(N - 7, pos);
+    ASSERT_EQ(0, T.min(N - 5, N, pos));
+    ASSERT_EQ(N - 1, pos);
+}
+
+TEST(CONCURRENT_TEST, RANDOM){
+    // a single thread against an array, with batches of random size
+    const int N = 1000;
+    const int Q = 100000;
+    vector<ll> A = random_array(N), published = A;
+    ConcurrentSegTree<ll> T(A);
+    T.batch_size = 1000000;
+
+    for (int i = 0; i < Q; i++){
+        int l = rand() % N;
+        int r = rand() % N + 1;
+        if (l > r) swap(l, r);
+        int t = rand() % 4;
+        if (t == 0){
+            int x = rand() - rand();
+            for (int j = l; j < r; j++) A[j] += x;
+            T.add(l, r, x);
+        } else if (t == 1){
+            if (rand() % 8 == 0){
+                T.publish();
+                published = A;
+            }
+        } else if (t == 2){
+            ll sum = 0;
+            for (int j = l; j < r; j++) sum += published[j];
+            ASSERT_EQ(sum, T.sum(l, r));
+        } else {
+            ll m = numeric_limits<ll>::max();
+            for (int j = l; j < r; j++) m = min(m, published[j]);
+            int pos;
+            ASSERT_EQ(m, T.min(l, r, pos));
+            if (l < r){
+                ASSERT_EQ(m, published[pos]);
+            }
+        }
+    }
+}
+
+TEST(CONCURRENT_TEST, TIE){
+    // the rightmost position of the minimum, as SegTree
+    ConcurrentSegTree<ll> T(vector<ll>(10, 5));
+    int pos;
+    ASSERT_EQ(5, T.min(2, 7, pos));
+    ASSERT_EQ(6, pos);
+    T.add(3, 5, -1);
+    ASSERT_EQ(4, T.min(0, 10, pos));
+    ASSERT_EQ(4, pos);
+
+    // against SegTree with many ties
+    const int N = 1000;
+    vector<ll> A(N);
+    for (auto &a : A) a = rand() % 4;
+    ConcurrentSegTree<ll> C(A);
+    SegTree<ll> S(A);
+    for (int i = 0; i < 10000; i++){
+        int l = rand() % N;
+        int r = rand() % N + 1;
+        if (l > r) swap(l, r);
+        if (rand() % 2){
+            int x = rand() % 3 - 1;
+            C.add(l, r, x);
+            S.add(l, r, x);
+        } else if (l < r){
+            int p1, p2;
+            ASSERT_EQ(S.min(l, r, p1), C.min(l, r, p2));
+            ASSERT_EQ(p1, p2);
+        }
+    }
+}
+
+TEST(CONCURRENT_TEST, READERS_AND_WRITERS){
+    // each batch moves an amount between two elements, so every reader has
+    // to see the same total; the final tree is compared with an array
+    const int N = 10000;
+    const int R = 4, W = 2, Q = 20000;
+    vector<ll> A = random_array(N);
+    ll total = 0;
+    for (ll a : A) total += a;
+    ConcurrentSegTree<ll> T(A);
+    T.batch_size = 2;
+    mutex m;
+    atomic<bool> done(false), ok(true);
+
+    vector<thread> ts;
+    for (int i = 0; i < R; i++)
+        ts.emplace_back([&](){
+            // back off between the queries, or the writers waiting for
+            // the readers to leave hardly run on a single core
+            while (!done.load()){
+                if (T.sum(0, N) != total) ok.store(false);
+                this_thread::sleep_for(chrono::microseconds(50));
+            }
+        });
+    vector<thread> ws;
+    for (int i = 0; i < W; i++)
+        ws.emplace_back([&, i](){
+            mt19937 gen(i);
+            for (int q = 0; q < Q; q++){
+                int p = gen() % N, r = gen() % N;
+                ll x = (int)gen() % 1000;
+                lock_guard<mutex> lock(m);  // the two adds are one batch
+                A[p] += x;
+                A[r] -= x;
+                T.add(p, p + 1, x);
+                T.add(r, r + 1, -x);
+            }
+        });
+    for (auto &t : ws) t.join();
+    done.store(true);
+    for (auto &t : ts) t.join();
+
+    ASSERT_TRUE(ok.load());
+    for (int i = 0; i < 1000; i++){
+        int l = rand() % N;
+        int r = rand() % N + 1;
+        if (l > r) swap(l, r);
+        ll sum = 0, mn = numeric_limits<ll>::max();
+        for (int j = l; j < r; j++){
+            sum += A[j];
+            mn = min(mn, A[j]);
+        }
+        ASSERT_EQ(sum, T.sum(l, r));
+        ASSERT_EQ(mn, T.min(l, r));
+    }
+}
+
+TEST(CONCURRENT_TEST, BENCHMARK){
+    // queries per second of k readers while one writer adds in batches of
+    // 64, against SegTree behind a mutex
+    const int N = 1000000;
+    const double seconds = 0.5;
+    vector<ll> A = random_array(N);
+    ConcurrentSegTree<ll> C(A);
+    C.batch_size = 64;
+    SegTree<ll> S(A);
+    mutex m;
+
+    int max_threads = max(2u, thread::hardware_concurrency());
+    for (int k = 1; k <= max_threads; k *= 2){
+        for (int concurrent = 1; concurrent >= 0; concurrent--){
+            atomic<bool> done(false);
+            atomic<long long> queries(0), check(0);
+            vector<thread> ts;
+            for (int i = 0; i < k; i++)
+                ts.emplace_back([&, i](){
+                    mt19937 gen(i);
+                    long long n = 0;
+                    ll c = 0;
+                    while (!done.load()){
+                        int l = gen() % N, r = gen() % N + 1;
+                        if (l > r) swap(l, r);
+                        if (concurrent) c += C.sum(l, r);
+                        else {
+                            lock_guard<mutex> lock(m);
+                            c += S.sum(l, r);
+                        }
+                        n++;
+                    }
+                    queries += n;
+                    check += c;         // keep the queries
+                });
+            thread writer([&](){
+                mt19937 gen(12345);
+                while (!done.load()){
+                    int l = gen() % N, r = gen() % N + 1;
+                    if (l > r) swap(l, r);
+                    if (concurrent) C.add(l, r, 1);
+                    else {
+                        lock_guard<mutex> lock(m);
+                        S.add(l, r, 1);
+                    }
+                }
+            });
+            this_thread::sleep_for(chrono::duration<double>(seconds));
+            done.store(true);
+            for (auto &t : ts) t.join();
+            writer.join();
+            cerr << (concurrent ? "ConcurrentSegTree" : "SegTree + mutex  ") << ", " << k
+                 << " readers: " << queries.load() / seconds << " queries / s (" << (check & 1) << ")" << endl;
+        }
+    }
+}
+
+TEST(ADD_SUM_MIN_TEST, BENCHMARK){
+    // 10^6 range add / sum / min operations on 10^6 elements
+    const int N = 1000000;
+    const int Q = 1000000;
+    SegTree<ll> T(random_array(N));
+    ll  check = 0;
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < Q; i++){
+        int l = rand() % N;
+        int r = rand() % N + 1;
+        if (l > r) swap(l, r);
+        int t = i % 3;
+        if (t == 0)      T.add(l, r, i % 7 - 3);
+        else if (t == 1) check += T.sum(l, r);
+        else             check += T.min(l, r);
+    }
+    auto end = chrono::steady_clock::now();
+    cerr << "seconds for " << Q << " operations: "
+         << chrono::duration<double>(end - start).count() << " (" << check << ")" << endl;
+}
+
 int main(int argc, char **argv){
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,263 @@
+/***************************************
+Wide (B-ary) Segment Tree
+
+point update and range sum / min for a capacity fixed at construction.
+
+level 0 holds the values, and the j-th element of level h + 1 is the sum
+(min) of the j-th block of B = 16 elements of level h. the levels are
+64-byte aligned, so a block is one cache line for 32-bit types and two
+for 64-bit ones; a query reads a few lines per level over log_16 N levels
+instead of two nodes per level over log_2 N.
+
+a range query takes the partial blocks at both ends of the range on each
+level and moves up with the whole blocks between them. a block is reduced
+with a mask of the lanes in [from, to):
+- AVX2 kernels for 32-bit and 64-bit signed integers, or SSE4.1 for
+  32-bit ones, chosen by __AVX2__ / __SSE4_1__ (compile with -mavx2 or
+  -march=native, e.g. make test-native)
+- a scalar loop for the other types or without them
+the stock build (make test) has neither flag, so it always runs the
+scalar loop.
+
+member method
+- void set(int p, T x), add(int p, T x)
+- T    get(int p)
+- T    sum(int l, int r), min(int l, int r)   // of [l, r)
+***************************************/
+
+#ifndef GUARD_WIDE_SEGMENT_TREE
+#define GUARD_WIDE_SEGMENT_TREE
+
+#include <algorithm>
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+// the sum / min of block[from, to) for a block of 16 elements. Size is
+// sizeof(T) for signed integers (which have SIMD kernels), 0 otherwise.
+template <typename T, int Size> struct WideKernel{
+  static T sum(const T *block, int from, int to){
+    T s = 0;
+    for(int i = from; i < to; i++) s += block[i];
+    return s;
+  }
+  static T min(const T *block, int from, int to){
+    T m = std::numeric_limits<T>::max();
+    for(int i = from; i < to; i++) m = std::min(m, block[i]);
+    return m;
+  }
+};
+
+#if defined(__AVX2__)
+// the lanes of block[base, base + 8) (base + 4) which are in [from, to)
+inline __m256i wide_mask32(int base, int from, int to){
+  __m256i idx = _mm256_add_epi32(_mm256_set1_epi32(base), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+  return _mm256_and_si256(_mm256_cmpgt_epi32(idx, _mm256_set1_epi32(from - 1)),
+                          _mm256_cmpgt_epi32(_mm256_set1_epi32(to), idx));
+}
+
+inline __m256i wide_mask64(int base, int from, int to){
+  __m256i idx = _mm256_add_epi64(_mm256_set1_epi64x(base), _mm256_setr_epi64x(0, 1, 2, 3));
+  return _mm256_and_si256(_mm256_cmpgt_epi64(idx, _mm256_set1_epi64x(from - 1)),
+                          _mm256_cmpgt_epi64(_mm256_set1_epi64x(to), idx));
+}
+
+template <typename T> struct WideKernel<T, 4>{
+  static T sum(const T *block, int from, int to){
+    __m256i a = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)block),       wide_mask32(0, from, to));
+    __m256i b = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(block + 8)), wide_mask32(8, from, to));
+    __m256i s = _mm256_add_epi32(a, b);
+    __m128i t = _mm_add_epi32(_mm256_castsi256_si128(s), _mm256_extracti128_si256(s, 1));
+    t = _mm_add_epi32(t, _mm_shuffle_epi32(t, 0x4e));
+    t = _mm_add_epi32(t, _mm_shuffle_epi32(t, 0xb1));
+    return _mm_cvtsi128_si32(t);
+  }
+  static T min(const T *block, int from, int to){
+    __m256i inf = _mm256_set1_epi32(std::numeric_limits<int32_t>::max());
+    __m256i a = _mm256_blendv_epi8(inf, _mm256_loadu_si256((const __m256i*)block),       wide_mask32(0, from, to));
+    __m256i b = _mm256_blendv_epi8(inf, _mm256_loadu_si256((const __m256i*)(block + 8)), wide_mask32(8, from, to));
+    __m256i m = _mm256_min_epi32(a, b);
+    __m128i t = _mm_min_epi32(_mm256_castsi256_si128(m), _mm256_extracti128_si256(m, 1));
+    t = _mm_min_epi32(t, _mm_shuffle_epi32(t, 0x4e));
+    t = _mm_min_epi32(t, _mm_shuffle_epi32(t, 0xb1));
+    return _mm_cvtsi128_si32(t);
+  }
+};
+
+template <typename T> struct WideKernel<T, 8>{
+  static T sum(const T *block, int from, int to){
+    __m256i s = _mm256_setzero_si256();
+    for(int i = 0; i < 16; i += 4)
+      s = _mm256_add_epi64(s, _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(block + i)),
+                                               wide_mask64(i, from, to)));
+    __m128i t = _mm_add_epi64(_mm256_castsi256_si128(s), _mm256_extracti128_si256(s, 1));
+    return _mm_cvtsi128_si64(t) + _mm_extract_epi64(t, 1);
+  }
+  static T min(const T *block, int from, int to){
+    // no min_epi64 in AVX2: compare and select with and / andnot / or
+    __m256i inf = _mm256_set1_epi64x(std::numeric_limits<int64_t>::max());
+    __m256i m   = inf;
+    for(int i = 0; i < 16; i += 4){
+      __m256i in = wide_mask64(i, from, to);
+      __m256i v  = _mm256_or_si256(_mm256_and_si256(in, _mm256_loadu_si256((const __m256i*)(block + i))),
+                                   _mm256_andnot_si256(in, inf));
+      __m256i gt = _mm256_cmpgt_epi64(m, v);
+      m = _mm256_or_si256(_mm256_and_si256(gt, v), _mm256_andnot_si256(gt, m));
+    }
+    alignas(32) int64_t lane[4];
+    _mm256_store_si256((__m256i*)lane, m);
+    return std::min(std::min(lane[0], lane[1]), std::min(lane[2], lane[3]));
+  }
+};
+#elif defined(__SSE4_1__)
+inline __m128i wide_mask32(int base, int from, int to){
+  __m128i idx = _mm_add_epi32(_mm_set1_epi32(base), _mm_setr_epi32(0, 1, 2, 3));
+  return _mm_and_si128(_mm_cmpgt_epi32(idx, _mm_set1_epi32(from - 1)),
+                       _mm_cmplt_epi32(idx, _mm_set1_epi32(to)));
+}
+
+template <typename T> struct WideKernel<T, 4>{
+  static T sum(const T *block, int from, int to){
+    __m128i s = _mm_setzero_si128();
+    for(int i = 0; i < 16; i += 4)
+      s = _mm_add_epi32(s, _mm_and_si128(_mm_loadu_si128((const __m128i*)(block + i)), wide_mask32(i, from, to)));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4e));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xb1));
+    return _mm_cvtsi128_si32(s);
+  }
+  static T min(const T *block, int from, int to){
+    __m128i inf = _mm_set1_epi32(std::numeric_limits<int32_t>::max());
+    __m128i m   = inf;
+    for(int i = 0; i < 16; i += 4)
+      m = _mm_min_epi32(m, _mm_blendv_epi8(inf, _mm_loadu_si128((const __m128i*)(block + i)), wide_mask32(i, from, to)));
+    m = _mm_min_epi32(m, _mm_shuffle_epi32(m, 0x4e));
+    m = _mm_min_epi32(m, _mm_shuffle_epi32(m, 0xb1));
+    return _mm_cvtsi128_si32(m);
+  }
+};
+#endif
+
+template <typename T> class WideSegTree{
+  enum { B = 16 };
+  typedef WideKernel<T, std::is_integral<T>::value && std::is_signed<T>::value ? sizeof(T) : 0> K;
+
+  int                 N;
+  int                 height;       // number of levels, the last one has 1 element
+  std::vector<T>      pool;         // all the levels, each 64-byte aligned
+  std::vector<size_t> sum_level, min_level;   // offsets into pool
+
+  inline T       *sums(int h)       { return &pool[sum_level[h]]; }
+  inline T       *mins(int h)       { return &pool[min_level[h]]; }
+  inline const T *sums(int h) const { return &pool[sum_level[h]]; }
+  inline const T *mins(int h) const { return &pool[min_level[h]]; }
+
+  // the elements of a cache line, and the first element of pool aligned to
+  // 64 bytes. pool has a spare line for the alignment
+  static size_t line(){return 64 / sizeof(T) > 0 ? 64 / sizeof(T) : 1;}
+  static size_t aligned(const std::vector<T> &pool){
+    return ((64 - (uintptr_t)pool.data() % 64) % 64) / sizeof(T);
+  }
+
+  // recompute the ancestors of the element p of level 0
+  void pull(int p){
+    for(int h = 1; h < height; h++){
+      p /= B;
+      sums(h)[p] = K::sum(sums(h - 1) + p * B, 0, B);
+      mins(h)[p] = K::min(mins(h - 1) + p * B, 0, B);
+    }
+  }
+
+public:
+  WideSegTree(const std::vector<T> &A) : N(A.size()){
+    // the number of elements of each level, rounded up to whole blocks
+    std::vector<size_t> lens;
+    size_t n = std::max(N, 1);
+    for(;;){
+      lens.push_back((n + B - 1) / B * B);
+      if(n == 1) break;
+      n = (n + B - 1) / B;
+    }
+    height = lens.size();
+    size_t total = line();
+    for(size_t len : lens) total += 2 * ((len + line() - 1) / line() * line());
+    pool.assign(total, 0);
+    size_t offset = aligned(pool);
+    for(size_t len : lens){
+      sum_level.push_back(offset);
+      offset += (len + line() - 1) / line() * line();
+      min_level.push_back(offset);
+      offset += (len + line() - 1) / line() * line();
+      std::fill(&pool[min_level.back()], &pool[min_level.back()] + len, std::numeric_limits<T>::max());
+    }
+    std::copy(A.begin(), A.end(), sums(0));
+    std::copy(A.begin(), A.end(), mins(0));
+    for(int h = 1; h < height; h++){
+      for(size_t j = 0; j < lens[h]; j++){
+        if(j * B >= lens[h - 1]) break;
+        sums(h)[j] = K::sum(sums(h - 1) + j * B, 0, B);
+        mins(h)[j] = K::min(mins(h - 1) + j * B, 0, B);
+      }
+    }
+  }
+
+  WideSegTree(size_t N) : WideSegTree(std::vector<T>(N, 0)) {}
+
+  // a copied pool has its own alignment, so the levels are moved with the
+  // offset of its first aligned element (a move keeps the buffer)
+  WideSegTree(const WideSegTree &o){*this = o;}
+  WideSegTree(WideSegTree &&o) = default;
+  WideSegTree &operator=(WideSegTree &&o) = default;
+
+  WideSegTree &operator=(const WideSegTree &o){
+    if(this == &o) return *this;
+    N      = o.N;
+    height = o.height;
+    pool.assign(o.pool.size(), 0);
+    size_t from = o.sum_level[0], to = aligned(pool);
+    std::copy(o.pool.begin() + from, o.pool.end() - line() + from, pool.begin() + to);
+    sum_level.clear();
+    min_level.clear();
+    for(int h = 0; h < height; h++){
+      sum_level.push_back(o.sum_level[h] - from + to);
+      min_level.push_back(o.min_level[h] - from + to);
+    }
+    return *this;
+  }
+
+  T    get(int p) const {return sums(0)[p];}
+  void set(int p, T x){sums(0)[p] = mins(0)[p] = x; pull(p);}
+  void add(int p, T x){set(p, get(p) + x);}
+
+  T sum(int l, int r) const {
+    T res = 0;
+    for(int h = 0; l < r; h++){
+      int bl = l / B, br = r / B;
+      if(bl == br) return res + K::sum(sums(h) + bl * B, l % B, r % B);
+      if(l % B) res += K::sum(sums(h) + bl++ * B, l % B, B);
+      if(r % B) res += K::sum(sums(h) + br * B, 0, r % B);
+      l = bl;
+      r = br;
+    }
+    return res;
+  }
+
+  T min(int l, int r) const {
+    T res = std::numeric_limits<T>::max();
+    for(int h = 0; l < r; h++){
+      int bl = l / B, br = r / B;
+      if(bl == br) return std::min(res, K::min(mins(h) + bl * B, l % B, r % B));
+      if(l % B) res = std::min(res, K::min(mins(h) + bl++ * B, l % B, B));
+      if(r % B) res = std::min(res, K::min(mins(h) + br * B, 0, r % B));
+      l = bl;
+      r = br;
+    }
+    return res;
+  }
+};
+
+#endif
@@ -2,10 +2,21 @@
 蟻本にのっている２回dfsをする方法
 非再帰による実装
 O(V + E)
+
+グラフは隣接リスト (vector<vector<int> >) か CSR (v の隣接頂点が
+adj[start[v]] .. adj[start[v + 1] - 1]) で与える.
+Build() は内部のバッファを再利用するので, 同じオブジェクトで何度も
+解けば 2 回目以降はメモリ確保が起きない.
+成分の番号は縮約グラフのトポロジカル順 (u -> v なら scc[u] <= scc[v]).
+
+member method
+- void Build(size_t V, const int *start, const int *adj)  // CSR
+- int  operator[](size_t v)   // v の成分の番号
+- int  NumComponents()
 ***********************************************************/
+#ifndef GUARD_STRONG_CONNECTED_COMPONENTS
+#define GUARD_STRONG_CONNECTED_COMPONENTS
 
-#include <stack>
-#include <queue>
 #include <vector>
 #include <cstdlib>
 #include <cassert>
@@ -15,63 +26,94 @@ class StrongConnectedComponent{
     typedef std::vector<std::vector<int> > Graph; // adjacency list
 private:
     size_t V;
-    std::vector<bool> visit;
+    int    num_components;
+    std::vector<char> visit;
     std::vector<int>  scc;
-    
-    void dfs(int v, std::vector<int> &vs, const Graph &G){
-        std::stack <int> to_visit;
-        std::vector<int> iters(V, 0);
-        to_visit .push(v);
-        
+    std::vector<int>  iters;          // 次に見る辺の位置
+    std::vector<int>  to_visit;
+    std::vector<int>  vs;             // 帰りがけ順
+    std::vector<int>  rstart, radj;   // 逆グラフ (CSR)
+    std::vector<int>  start_, adj_;   // 隣接リストから作った CSR
+
+    void dfs(int s, const int *start, const int *adj){
+        to_visit.push_back(s);
+        visit[s] = true;
+        iters[s] = start[s];
         while (!to_visit.empty()){
-            int    v = to_visit.top(); to_visit.pop();
-            if (iters[v] == 0) visit[v] = true;
-            if (iters[v] == (int)G[v].size()){
+            int v = to_visit.back();
+            if (iters[v] == start[v + 1]){
                 vs.push_back(v);
-            } else {
-                int to = G[v][iters[v]];
-                to_visit.push(v);
-                iters[v]++;
-                if (!visit[to]) to_visit.push(to);
+                to_visit.pop_back();
+                continue;
+            }
+            int to = adj[iters[v]++];
+            if (!visit[to]){
+                visit[to] = true;
+                iters[to] = start[to];
+                to_visit.push_back(to);
             }
         }
     }
-    
-    void rbfs(int s, int id, const Graph &G){
-        std::queue<int> que;
-        que.push(s);
+
+    void rdfs(int s, int id){
+        to_visit.push_back(s);
         visit[s] = true;
         scc[s]   = id;
-        while (!que.empty()){
-            int v = que.front(); que.pop();
-            for (auto to : G[v]){
+        while (!to_visit.empty()){
+            int v = to_visit.back(); to_visit.pop_back();
+            for (int i = rstart[v]; i < rstart[v + 1]; i++){
+                int to = radj[i];
                 if (!visit[to]){
                     visit[to] = true;
                     scc[to]   = id;
-                    que.push(to);
+                    to_visit.push_back(to);
                 }
             }
         }
     }
-    
+
 public:
-    StrongConnectedComponent(const Graph &G) : V(G.size()){
-        visit .resize(V, false);
-        scc   .resize(V, -1);
-        Graph rG(V);
+    StrongConnectedComponent() : V(0), num_components(0) {}
+
+    StrongConnectedComponent(const Graph &G){
+        start_.assign(1, 0);
+        adj_  .clear();
+        for (size_t v = 0; v < G.size(); v++){
+            adj_.insert(adj_.end(), G[v].begin(), G[v].end());
+            start_.push_back(adj_.size());
+        }
+        Build(G.size(), start_.data(), adj_.data());
+    }
+
+    StrongConnectedComponent(size_t V, const int *start, const int *adj){
+        Build(V, start, adj);
+    }
+
+    void Build(size_t V, const int *start, const int *adj){
+        this->V = V;
+        visit .assign(V, false);
+        scc   .assign(V, -1);
+        iters .resize(V);
+        rstart.assign(V + 1, 0);
+        radj  .resize(start[V]);
+        for (int i = 0; i < start[V]; i++) rstart[adj[i] + 1]++;
+        for (size_t v = 0; v < V; v++) rstart[v + 1] += rstart[v];
+        std::copy(rstart.begin(), rstart.end() - 1, iters.begin());
         for (size_t v = 0; v < V; v++)
-            for (size_t i = 0; i < G[v].size(); i++)
-                rG[G[v][i]].push_back(v);
-        std::vector<int> vs;
-        for (size_t v = 0; v < V; v++) if (!visit[v]) dfs(v, vs, G);
+            for (int i = start[v]; i < start[v + 1]; i++) radj[iters[adj[i]]++] = v;
+
+        vs.clear();
+        for (size_t v = 0; v < V; v++) if (!visit[v]) dfs(v, start, adj);
         assert(vs.size() == V);
-        std::reverse(vs.begin(), vs.end());
         std::fill(visit.begin(), visit.end(), false);
-        int id = 0;
-        for (size_t v = 0; v < V; v++) if (!visit[vs[v]]) rbfs(vs[v], id++, rG);
+        num_components = 0;
+        for (size_t i = V; i-- > 0; ) if (!visit[vs[i]]) rdfs(vs[i], num_components++);
     }
+
     int operator[](size_t idx) const { return scc[idx]; }
+    int NumComponents() const { return num_components; }
 };
+#endif
 
 /***********************************************************
  solution for 
@@ -3,6 +3,7 @@
 #include <gtest/gtest.h>
 #include <boost/random.hpp>
 #include <boost/random/uniform_real.hpp>
+#include <random>
 #include "strong_connected_components.hpp"
 using namespace std;
 
@@ -123,6 +124,26 @@ TEST(SCC_TEST, RANDOM_MIDDLE_DENSE){
     random_graph_verify(1000, random_graph(1000, 0.5));
 }
 
+TEST(SCC_TEST, CSR_TOPOLOGICAL){
+    // the same graph as CSR, built twice by one object
+    Graph g = random_graph(300, 0.01);
+    StrongConnectedComponent expected(g);
+    vector<int> start(1, 0), adj;
+    for (auto &e : g){
+        adj.insert(adj.end(), e.begin(), e.end());
+        start.push_back(adj.size());
+    }
+    StrongConnectedComponent scc;
+    for (int t = 0; t < 2; t++){
+        scc.Build(g.size(), start.data(), adj.data());
+        ASSERT_EQ(scc.NumComponents(), expected.NumComponents());
+        for (size_t v = 0; v < g.size(); v++){
+            ASSERT_EQ(scc[v], expected[v]);
+            for (int w : g[v]) ASSERT_LE(scc[v], scc[w]);
+        }
+    }
+}
+
 int main(int argc, char **argv){
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
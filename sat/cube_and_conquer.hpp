@@ -0,0 +1,172 @@
+/***********************************************************
+Cube-and-Conquer on top of SatSolver
+
+1. cube: split the formula by lookahead into up to 2^max_depth cubes
+   (conjunctions of literals). at each node the variable v maximizing
+   (#implied by v + 1) * (#implied by ~v + 1) among the most frequent
+   variables is chosen. a failed literal is added to the cube with the
+   opposite sign, and a node where both signs fail is dropped.
+2. conquer: every thread owns an incremental SatSolver and a deque of
+   cubes, and solves Solve(cube) for each of them. an idle thread steals
+   from the front of another deque. the first satisfiable cube stops all
+   the threads.
+
+member method
+- bool Solve(vector<clause>)   // same as SatSolver::Solve
+member variables
+- int          num_threads, max_depth, candidates
+- vector<bool> model           // a valid assignment when Solve() == true
+- size_t       num_cubes, num_steals
+***********************************************************/
+#ifndef GUARD_CUBE_AND_CONQUER
+#define GUARD_CUBE_AND_CONQUER
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include "sat_solver.hpp"
+
+class CubeAndConquer{
+  struct Worker{
+    SatSolver  solver;
+    mutex      m;
+    deque<int> queue;        // indices of cubes
+  };
+
+  vector<vector<int> >        cubes;
+  vector<unique_ptr<Worker> > workers;
+  atomic<bool>                stop;
+  mutex                       result_mutex;
+  bool                        found;
+
+  void Split(SatSolver &s, const vector<int> &vars, vector<int> &cube, int depth){
+    for (;;){
+      if (depth == max_depth){
+        cubes.push_back(cube);
+        return;
+      }
+      int      best = 0;
+      uint64_t best_score = 0;
+      bool     failed = false;
+      for (int v : vars){
+        int pos = s.Lookahead(cube, v);
+        int neg = s.Lookahead(cube, -v);
+        if (pos == -2 || neg == -2) continue;      // already assigned
+        if (pos == -1 && neg == -1) return;        // the cube is refuted
+        if (pos == -1 || neg == -1){
+          cube.push_back(pos == -1 ? -v : v);      // failed literal
+          failed = true;
+          break;
+        }
+        uint64_t score = (uint64_t)(pos + 1) * (neg + 1);
+        if (score > best_score){
+          best_score = score;
+          best       = v;
+        }
+      }
+      if (failed) continue;
+      if (best == 0){              // every candidate is assigned
+        cubes.push_back(cube);
+        return;
+      }
+      size_t size = cube.size();
+      cube.push_back(best);
+      Split(s, vars, cube, depth + 1);
+      cube.resize(size);
+      cube.push_back(-best);
+      Split(s, vars, cube, depth + 1);
+      cube.resize(size);
+      return;
+    }
+  }
+
+  // pop from the own deque, or steal from the front of another one
+  bool Next(int id, int &cube){
+    for (int k = 0; k < num_threads; k++){
+      Worker &w = *workers[(id + k) % num_threads];
+      lock_guard<mutex> lock(w.m);
+      if (w.queue.empty()) continue;
+      if (k == 0){
+        cube = w.queue.back();
+        w.queue.pop_back();
+      } else {
+        cube = w.queue.front();
+        w.queue.pop_front();
+        num_steals++;
+      }
+      return true;
+    }
+    return false;
+  }
+
+  void Run(int id){
+    SatSolver &s = workers[id]->solver;
+    int cube;
+    while (!stop && Next(id, cube)){
+      if (!s.Solve(cubes[cube])){
+        if (s.Interrupted()) return;
+        continue;
+      }
+      lock_guard<mutex> lock(result_mutex);
+      if (!found){
+        found = true;
+        model = s.model;
+      }
+      stop = true;
+    }
+  }
+
+public:
+  int            num_threads;
+  int            max_depth;
+  int            candidates;       // variables tried by the lookahead
+  vector<bool>   model;
+  size_t         num_cubes;
+  atomic<size_t> num_steals;
+
+  CubeAndConquer(int num_threads = thread::hardware_concurrency())
+    : num_threads(max(num_threads, 1)), max_depth(8), candidates(32),
+      num_cubes(0), num_steals(0) {}
+
+  bool Solve(const vector<vector<int> > &cs){
+    workers.clear();
+    for (int i = 0; i < num_threads; i++){
+      workers.emplace_back(new Worker());
+      workers[i]->solver.terminate = &stop;
+      for (auto &c : cs) workers[i]->solver.AddClause(c);
+    }
+
+    // most frequent variables are the candidates of the lookahead
+    vector<pair<int, int> > occ;
+    for (auto &c : cs){
+      for (int l : c){
+        if (abs(l) >= (int)occ.size()) occ.resize(abs(l) + 1, make_pair(0, 0));
+        occ[abs(l)].first--;
+        occ[abs(l)].second = abs(l);
+      }
+    }
+    sort(occ.begin(), occ.end());
+    vector<int> vars;
+    for (size_t i = 0; i < occ.size() && (int)vars.size() < candidates; i++)
+      if (occ[i].first < 0) vars.push_back(occ[i].second);
+
+    cubes.clear();
+    vector<int> cube;
+    Split(workers[0]->solver, vars, cube, 0);
+    num_cubes = cubes.size();
+    for (size_t i = 0; i < cubes.size(); i++)
+      workers[i % num_threads]->queue.push_back(i);
+
+    stop       = false;
+    found      = false;
+    num_steals = 0;
+    vector<thread> threads;
+    for (int i = 0; i < num_threads; i++) threads.emplace_back(&CubeAndConquer::Run, this, i);
+    for (auto &t : threads) t.join();
+    return found;
+  }
+};
+#endif
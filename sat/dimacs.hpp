@@ -0,0 +1,151 @@
+/***********************************************************
+DIMACS CNF reader
+
+- the file is memory-mapped and scanned in place (no iostreams)
+- any istream (e.g. a gzip decompressing stream) is read in chunks
+- clauses are passed to a callback as [begin, end) of int literals
+  through one reused buffer, so no vector is built per clause
+
+member method
+- bool ParseFile  (path, add)   // mmap
+- bool ParseStream(istream, add)
+  add(const int *begin, const int *end) is called for every clause.
+  return false if the file can not be read or has an unexpected character.
+member variables
+- int  num_vars, num_clauses   // from the "p cnf" line (0 if missing)
+- size_t bytes                 // number of bytes scanned
+
+bool LoadDimacs(path, SatSolver &) loads a file directly into the solver.
+
+comment lines ("c ...") are skipped and a line starting with '%' ends the
+input (as in the SATLIB benchmarks).
+***********************************************************/
+#ifndef GUARD_DIMACS
+#define GUARD_DIMACS
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <string>
+#include <istream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "sat_solver.hpp"
+
+class DimacsParser{
+  std::vector<int> lits;      // the current clause
+  bool             finished;  // '%' line was read
+
+  static inline bool IsSpace(char c){ return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+  // scan [p, end); every line in it has to be complete
+  template <typename F> bool Scan(const char *p, const char *end, F &add){
+    bytes += end - p;
+    while (p != end && !finished){
+      char c = *p;
+      if (IsSpace(c)){
+        p++;
+      } else if (c == 'c' || c == 'p'){
+        const char *eol = static_cast<const char*>(memchr(p, '\n', end - p));
+        if (eol == nullptr) eol = end;
+        if (c == 'p') ParseHeader(p, eol);
+        p = eol;
+      } else if (c == '%'){
+        finished = true;
+      } else {
+        bool neg = false;
+        if (c == '-'){ neg = true; p++; }
+        if (p == end || *p < '0' || *p > '9') return false;
+        int x = 0;
+        while (p != end && *p >= '0' && *p <= '9') x = x * 10 + (*p++ - '0');
+        if (x == 0){
+          add(lits.data(), lits.data() + lits.size());
+          lits.clear();
+        } else {
+          lits.push_back(neg ? -x : x);
+        }
+      }
+    }
+    return true;
+  }
+
+  void ParseHeader(const char *p, const char *eol){
+    std::string line(p, eol);
+    char fmt[8];
+    if (sscanf(line.c_str(), "p %7s %d %d", fmt, &num_vars, &num_clauses) != 3)
+      num_vars = num_clauses = 0;
+  }
+
+  void Reset(){
+    lits.clear();
+    finished = false;
+    num_vars = num_clauses = 0;
+    bytes = 0;
+  }
+
+  // a clause without the final 0 at the end of the input
+  template <typename F> void Finish(F &add){
+    if (!lits.empty()) add(lits.data(), lits.data() + lits.size());
+    lits.clear();
+  }
+
+public:
+  int    num_vars;
+  int    num_clauses;
+  size_t bytes;
+
+  DimacsParser() { Reset(); }
+
+  template <typename F> bool ParseFile(const char *path, F add){
+    Reset();
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0){ close(fd); return false; }
+    if (st.st_size == 0){ close(fd); return true; }
+    void *mem = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED) return false;
+    madvise(mem, st.st_size, MADV_SEQUENTIAL);
+    const char *p = static_cast<const char*>(mem);
+    bool res = Scan(p, p + st.st_size, add);
+    munmap(mem, st.st_size);
+    if (res) Finish(add);
+    return res;
+  }
+
+  template <typename F> bool ParseStream(std::istream &is, F add, size_t chunk = 1 << 20){
+    Reset();
+    std::vector<char> buf(chunk);
+    size_t len = 0;             // bytes carried over from the previous chunk
+    while (!finished){
+      if (len == buf.size()) buf.resize(buf.size() * 2);   // a very long line
+      is.read(buf.data() + len, buf.size() - len);
+      size_t got = is.gcount();
+      if (got == 0) break;
+      len += got;
+      // scan up to the last newline and keep the rest for the next chunk
+      size_t upto = len;
+      while (upto > 0 && buf[upto - 1] != '\n') upto--;
+      if (upto == 0) continue;
+      if (!Scan(buf.data(), buf.data() + upto, add)) return false;
+      memmove(buf.data(), buf.data() + upto, len - upto);
+      len -= upto;
+    }
+    if (!finished && !Scan(buf.data(), buf.data() + len, add)) return false;
+    Finish(add);
+    return true;
+  }
+};
+
+// read the clauses of a DIMACS file into solver. return false on a read error.
+inline bool LoadDimacs(const char *path, SatSolver &solver){
+  DimacsParser parser;
+  return parser.ParseFile(path, [&solver](const int *begin, const int *end){
+      solver.AddClause(begin, end);
+    });
+}
+#endif
@@ -0,0 +1,120 @@
+/***********************************************************
+DRAT proof writer
+
+SatSolver writes every learnt clause (addition) and every removed clause
+(deletion) here when its member "proof" is set, and the empty clause when
+the formula is found to be unsatisfiable. the proof can be checked by
+drat-trim or by DratChecker (drat_checker.hpp).
+
+- text format  :   "l1 l2 ... 0" / "d l1 l2 ... 0"
+- binary format:   'a' / 'd', then each literal as 2 * var + sign in
+                   7-bit variable length encoding, then 0
+
+the solver only appends bytes to a buffer; a full buffer is handed to a
+background thread which writes it to the stream, so the search does not
+wait for I/O unless the writer falls a whole buffer behind.
+
+member method
+- void Begin(bool deletion), Push(int lit), End()   // one clause
+- void Close()   // flush and stop the writer thread (also in the destructor)
+
+proofs are only meaningful for Solve() without assumptions, preprocess and
+ImportClause().
+***********************************************************/
+#ifndef GUARD_DRAT
+#define GUARD_DRAT
+
+#include <cstdlib>
+#include <cstdio>
+#include <vector>
+#include <ostream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+class DratWriter{
+  std::ostream            &os;
+  bool                     binary;
+  size_t                   buffer_size;
+  std::vector<char>        current;     // filled by the solver
+  std::vector<char>        pending;     // written by the writer thread
+  bool                     closing;
+  std::mutex               m;
+  std::condition_variable  cv;
+  std::thread              writer;
+
+  void Loop(){
+    std::unique_lock<std::mutex> lock(m);
+    for (;;){
+      cv.wait(lock, [this](){ return !pending.empty() || closing; });
+      if (pending.empty()) return;
+      lock.unlock();
+      os.write(pending.data(), pending.size());
+      lock.lock();
+      pending.clear();
+      cv.notify_all();
+    }
+  }
+
+  void Flush(){
+    std::unique_lock<std::mutex> lock(m);
+    cv.wait(lock, [this](){ return pending.empty(); });
+    current.swap(pending);
+    cv.notify_all();
+  }
+
+public:
+  DratWriter(std::ostream &os, bool binary = false, size_t buffer_size = 1 << 20)
+    : os(os), binary(binary), buffer_size(buffer_size), closing(false),
+      writer(&DratWriter::Loop, this) {
+    current.reserve(buffer_size + 64);
+    pending.reserve(buffer_size + 64);
+  }
+
+  ~DratWriter(){ Close(); }
+
+  inline void Begin(bool deletion){
+    if (binary) current.push_back(deletion ? 'd' : 'a');
+    else if (deletion){
+      current.push_back('d');
+      current.push_back(' ');
+    }
+  }
+
+  inline void Push(int lit){
+    if (binary){
+      unsigned u = 2 * abs(lit) + (lit < 0);
+      while (u > 127){
+        current.push_back((char)(128 | (u & 127)));
+        u >>= 7;
+      }
+      current.push_back((char)u);
+    } else {
+      char tmp[16];
+      int  len = snprintf(tmp, sizeof(tmp), "%d ", lit);
+      current.insert(current.end(), tmp, tmp + len);
+    }
+  }
+
+  inline void End(){
+    if (binary) current.push_back(0);
+    else {
+      current.push_back('0');
+      current.push_back('\n');
+    }
+    if (current.size() >= buffer_size) Flush();
+  }
+
+  void Close(){
+    if (!writer.joinable()) return;
+    Flush();
+    {
+      std::lock_guard<std::mutex> lock(m);
+      closing = true;
+      cv.notify_all();
+    }
+    writer.join();
+    os.flush();
+  }
+};
+#endif
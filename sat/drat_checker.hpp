@@ -0,0 +1,198 @@
+/***********************************************************
+DRAT proof checker (forward checking)
+
+every added lemma has to be RUP (unit propagation on the negation of the
+lemma gives a conflict) or RAT on its first literal, and the proof has to
+derive the empty clause. used by the tests to verify the proofs written
+by SatSolver through DratWriter.
+
+member method
+- bool Check(vector<clause> cs, string proof, bool binary)
+member variables
+- size_t num_lemmas, num_deletions
+***********************************************************/
+#ifndef GUARD_DRAT_CHECKER
+#define GUARD_DRAT_CHECKER
+
+#include <cstdlib>
+#include <vector>
+#include <string>
+#include <map>
+#include <algorithm>
+
+class DratChecker{
+  std::vector<std::vector<int> > clauses;  // two watched literals first
+  std::vector<bool>              alive;
+  std::vector<std::vector<int> > watch;    // clause ids by literal index
+  std::vector<int>               units;    // ids of alive unit clauses
+  std::map<std::vector<int>, std::vector<int> > ids;   // sorted literals -> ids
+  std::vector<signed char>       value;    // by variable
+  std::vector<int>               trail;
+
+  static inline int Index(int l){ return 2 * abs(l) + (l < 0); }
+  inline int Value(int l) const { return l > 0 ? value[l] : -value[-l]; }
+
+  void EnsureVar(int v){
+    if (v < (int)value.size()) return;
+    value.resize(v + 1, 0);
+    watch.resize(2 * (v + 1));
+  }
+
+  static std::vector<int> Key(std::vector<int> c){
+    std::sort(c.begin(), c.end());
+    c.erase(std::unique(c.begin(), c.end()), c.end());
+    return c;
+  }
+
+  void Add(const std::vector<int> &c){
+    std::vector<int> key = Key(c);
+    for (int l : key) EnsureVar(abs(l));
+    int id = clauses.size();
+    clauses.push_back(key);
+    alive  .push_back(true);
+    ids[key].push_back(id);
+    if (key.size() == 1) units.push_back(id);
+    for (size_t i = 0; i < key.size() && i < 2; i++) watch[Index(-key[i])].push_back(id);
+  }
+
+  void Delete(const std::vector<int> &c){
+    auto it = ids.find(Key(c));
+    if (it == ids.end() || it->second.empty()) return;   // ignored as drat-trim
+    int id = it->second.back();
+    it->second.pop_back();
+    alive[id] = false;
+    num_deletions++;
+  }
+
+  // false on a conflict
+  bool Assign(int l){
+    if (Value(l) == -1) return false;
+    if (Value(l) == 0){
+      value[abs(l)] = l > 0 ? 1 : -1;
+      trail.push_back(l);
+    }
+    return true;
+  }
+
+  // true if unit propagation from the current assignment gives a conflict
+  bool Propagate(){
+    for (int u : units) if (alive[u] && !Assign(clauses[u][0])) return true;
+    for (size_t head = 0; head < trail.size(); head++){
+      std::vector<int> &ws = watch[Index(trail[head])];      // ~trail[head] is false
+      size_t j = 0;
+      bool conflict = false;
+      for (size_t i = 0; i < ws.size(); i++){
+        int id = ws[i];
+        std::vector<int> &c = clauses[id];
+        if (!alive[id]) continue;
+        if (conflict){ ws[j++] = id; continue; }
+        if (c[0] == -trail[head]) std::swap(c[0], c[1]);
+        if (Value(c[0]) == 1){ ws[j++] = id; continue; }
+        size_t k = 2;
+        while (k < c.size() && Value(c[k]) == -1) k++;
+        if (k < c.size()){
+          std::swap(c[1], c[k]);
+          watch[Index(-c[1])].push_back(id);
+          continue;
+        }
+        ws[j++] = id;
+        if (!Assign(c[0])) conflict = true;
+      }
+      ws.resize(j);
+      if (conflict) return true;
+    }
+    return false;
+  }
+
+  void Reset(){
+    for (int l : trail) value[abs(l)] = 0;
+    trail.clear();
+  }
+
+  bool Rup(const std::vector<int> &lemma){
+    bool res = false;
+    for (int l : lemma) if (!Assign(-l)) res = true;
+    if (!res) res = Propagate();
+    Reset();
+    return res;
+  }
+
+  bool Rat(const std::vector<int> &lemma){
+    if (lemma.empty()) return false;
+    int pivot = lemma[0];
+    for (size_t id = 0; id < clauses.size(); id++){
+      if (!alive[id]) continue;
+      const std::vector<int> &d = clauses[id];
+      if (std::find(d.begin(), d.end(), -pivot) == d.end()) continue;
+      std::vector<int> resolvent = lemma;
+      for (int l : d) if (l != -pivot) resolvent.push_back(l);
+      bool tautology = false;
+      for (int l : resolvent)
+        if (std::find(resolvent.begin(), resolvent.end(), -l) != resolvent.end()) tautology = true;
+      if (!tautology && !Rup(resolvent)) return false;
+    }
+    return true;
+  }
+
+  // read the next clause of the proof from pos; false at the end
+  static bool Next(const std::string &proof, size_t &pos, bool binary,
+                   bool &deletion, std::vector<int> &c){
+    c.clear();
+    if (binary){
+      if (pos >= proof.size()) return false;
+      deletion = proof[pos++] == 'd';
+      for (;;){
+        unsigned u = 0, shift = 0;
+        unsigned char b;
+        do{
+          b = proof[pos++];
+          u |= (unsigned)(b & 127) << shift;
+          shift += 7;
+        }while (b & 128);
+        if (u == 0) return true;
+        c.push_back(u & 1 ? -(int)(u >> 1) : (int)(u >> 1));
+      }
+    }
+    while (pos < proof.size() && isspace((unsigned char)proof[pos])) pos++;
+    if (pos >= proof.size()) return false;
+    deletion = proof[pos] == 'd';
+    if (deletion) pos++;
+    for (;;){
+      char *end;
+      long x = strtol(proof.c_str() + pos, &end, 10);
+      pos = end - proof.c_str();
+      if (x == 0) return true;
+      c.push_back(x);
+    }
+  }
+
+public:
+  size_t num_lemmas;
+  size_t num_deletions;
+
+  bool Check(const std::vector<std::vector<int> > &cs, const std::string &proof, bool binary){
+    clauses.clear(); alive.clear(); watch.clear(); units.clear();
+    ids.clear(); value.clear(); trail.clear();
+    num_lemmas = num_deletions = 0;
+    for (auto &c : cs){
+      if (c.empty()) return true;
+      Add(c);
+    }
+    size_t           pos = 0;
+    bool             deletion;
+    std::vector<int> c;
+    while (Next(proof, pos, binary, deletion, c)){
+      if (deletion){
+        Delete(c);
+        continue;
+      }
+      for (int l : c) EnsureVar(abs(l));
+      if (!Rup(c) && !Rat(c)) return false;
+      num_lemmas++;
+      if (c.empty()) return true;
+      Add(c);
+    }
+    return false;
+  }
+};
+#endif
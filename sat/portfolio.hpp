@@ -0,0 +1,169 @@
+/***********************************************************
+Portfolio parallel SAT solver
+
+runs N diversified SatSolver instances on threads. the first one which
+finishes stops the others.
+- instance i uses seed i, alternates LUBY / GLUCOSE restarts and the
+  default phase, and some make a few random decisions
+- learnt clauses with size <= share_size and LBD <= share_lbd are written
+  to a lock-free ring owned by the learning thread (single producer);
+  every other thread reads the rings at its restarts and imports them.
+  each slot is a seqlock, so a clause overwritten while it is read is
+  never imported; a reader overtaken by the writer skips the lost clauses.
+
+member method
+- bool Solve(vector<clause>)   // same as SatSolver::Solve
+member variables
+- int          num_threads
+- vector<bool> model           // a valid assignment when Solve() == true
+- int          winner          // index of the instance which answered
+***********************************************************/
+#ifndef GUARD_PORTFOLIO
+#define GUARD_PORTFOLIO
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include "sat_solver.hpp"
+
+// a ring of slots of at most max_size literals, each guarded by a sequence
+// number (seqlock): the writer of the c-th clause sets it to 2c + 1 before
+// and to 2c + 2 after writing the slot c % slots. a reader keeps a copy
+// only if the number is 2c + 2 before and after copying it.
+class ClauseRing{
+  struct Slot{
+    atomic<uint64_t>     seq;
+    atomic<int>          size;
+    unique_ptr<atomic<int>[]> lits;
+  };
+  vector<Slot>         slots;
+  uint64_t             mask;
+  int                  max_size;
+  uint64_t             count;        // clauses written, only used by the writer
+public:
+  ClauseRing(int log_slots, int max_size)
+    : slots(1 << log_slots), mask((1 << log_slots) - 1), max_size(max_size), count(0) {
+    for (Slot &s : slots){
+      s.seq.store(0, memory_order_relaxed);
+      s.size.store(0, memory_order_relaxed);
+      s.lits.reset(new atomic<int>[max_size]);
+    }
+  }
+
+  // only the owner thread writes. a longer clause than max_size is dropped.
+  void Push(const int *begin, const int *end){
+    if (end - begin > max_size) return;
+    uint64_t c = count++;
+    Slot    &s = slots[c & mask];
+    s.seq.store(2 * c + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    s.size.store(end - begin, memory_order_relaxed);
+    for (int i = 0; begin + i != end; i++) s.lits[i].store(begin[i], memory_order_relaxed);
+    s.seq.store(2 * c + 2, memory_order_release);
+  }
+
+  // call f(begin, end) for every clause from the cursor-th on, and move
+  // cursor. the clauses overwritten before they are read are skipped.
+  template <typename F> void Read(uint64_t &cursor, vector<int> &tmp, F f){
+    for (;;){
+      Slot    &s    = slots[cursor & mask];
+      uint64_t want = 2 * cursor + 2;
+      uint64_t seq  = s.seq.load(memory_order_acquire);
+      if (seq < want) return;                      // not written yet, or being written
+      if (seq > want){                             // overtaken
+        cursor = (seq - 1) / 2 - mask;
+        continue;
+      }
+      int size = s.size.load(memory_order_relaxed);
+      if (size < 0 || size > max_size){            // torn, the check below fails
+        cursor++;
+        continue;
+      }
+      tmp.resize(size);
+      for (int i = 0; i < size; i++) tmp[i] = s.lits[i].load(memory_order_relaxed);
+      atomic_thread_fence(memory_order_acquire);
+      if (s.seq.load(memory_order_relaxed) != seq){   // overwritten meanwhile
+        cursor++;
+        continue;
+      }
+      cursor++;
+      f(tmp.data(), tmp.data() + size);
+    }
+  }
+};
+
+class PortfolioSolver{
+  struct Worker{
+    SatSolver        solver;
+    ClauseRing       ring;
+    vector<uint64_t> cursor;         // read position in the ring of each thread
+    Worker(int n, int share_size) : ring(13, share_size), cursor(n, 0) {}
+  };
+
+  vector<unique_ptr<Worker> > workers;
+  atomic<bool>                stop;
+  mutex                       result_mutex;
+  bool                        result;
+
+  void Configure(int id){
+    SatSolver &s = workers[id]->solver;
+    s.seed            = id;
+    s.restart_policy  = id % 2 == 0 ? SatSolver::GLUCOSE_RESTART : SatSolver::LUBY_RESTART;
+    s.default_phase   = id % 4 >= 2;
+    s.random_var_freq = id % 3 == 2 ? 0.02 : 0.0;
+    s.terminate       = &stop;
+    s.learnt_callback = [this, id](const int *begin, const int *end, uint32_t lbd){
+      if (end - begin <= share_size && lbd <= share_lbd) workers[id]->ring.Push(begin, end);
+    };
+    s.restart_callback = [this, id](){
+      Worker    &w = *workers[id];
+      vector<int> tmp;
+      for (size_t j = 0; j < workers.size(); j++){
+        if ((int)j == id) continue;
+        workers[j]->ring.Read(w.cursor[j], tmp, [this, &w](const int *begin, const int *end){
+            w.solver.ImportClause(begin, end, end - begin);
+            imported++;
+          });
+      }
+    };
+  }
+
+  void Run(int id, const vector<vector<int> > &cs){
+    SatSolver &s = workers[id]->solver;
+    bool res = s.Solve(cs);
+    if (s.Interrupted()) return;
+    lock_guard<mutex> lock(result_mutex);
+    if (winner >= 0) return;
+    winner = id;
+    result = res;
+    if (res) model = s.model;
+    stop = true;
+  }
+
+public:
+  int            num_threads;
+  int            share_size;
+  uint32_t       share_lbd;
+  vector<bool>   model;
+  int            winner;
+  atomic<size_t> imported;         // number of clauses received by all threads
+
+  PortfolioSolver(int num_threads = thread::hardware_concurrency())
+    : num_threads(max(num_threads, 1)), share_size(8), share_lbd(3), winner(-1), imported(0) {}
+
+  bool Solve(const vector<vector<int> > &cs){
+    workers.clear();
+    for (int i = 0; i < num_threads; i++) workers.emplace_back(new Worker(num_threads, share_size));
+    for (int i = 0; i < num_threads; i++) Configure(i);
+    stop     = false;
+    winner   = -1;
+    imported = 0;
+    vector<thread> threads;
+    for (int i = 0; i < num_threads; i++) threads.emplace_back(&PortfolioSolver::Run, this, i, cref(cs));
+    for (auto &t : threads) t.join();
+    return result;
+  }
+};
+#endif
@@ -0,0 +1,324 @@
+/***********************************************************
+CNF preprocessor (run before SatSolver)
+- Top-level Unit Propagation
+- Pure Literal Elimination
+- Forward / Backward Subsumption
+- Self-Subsuming Resolution (clause strengthening)
+- Bounded Variable Elimination
+
+literals are the same integers as in SatSolver (x / -x).
+
+member method
+- bool Run(vector<clause> cs, vector<clause> &out)
+    // simplify cs into an equisatisfiable out. return false if cs is
+    // found to be unsatisfiable.
+- void Extend(vector<bool> &model)
+    // turn a model of out into a model of cs
+
+every removal that can change the set of models (units, pure literals and
+eliminated clauses) is recorded as (witness literal, clause) on a stack.
+Extend() walks the stack backwards and flips the witness whenever its clause
+is not satisfied.
+
+eliminated variables must not appear in clauses added to the solver later.
+***********************************************************/
+#ifndef GUARD_PREPROCESSOR
+#define GUARD_PREPROCESSOR
+
+#include <cstdlib>
+#include <cassert>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+using namespace std;
+
+class Preprocessor{
+  int                  n;
+  bool                 ok;
+  vector<vector<int> > cls;
+  vector<bool>         removed;
+  vector<vector<int> > occ;        // clause ids by literal, may keep removed ids
+  vector<int>          value;      // +1, -1 or 0 by variable
+  vector<bool>         eliminated;
+  vector<int>          units;      // assigned but not propagated yet
+  vector<int>          touched;    // clauses to check for subsumption
+  vector<bool>         in_touched;
+  vector<uint32_t>     mark;       // by literal index
+  uint32_t             stamp;
+  vector<pair<int, vector<int> > > elim_stack;
+  size_t               eliminated_vars;
+  size_t               removed_clauses;
+
+  static inline int Index(int l){ return 2 * abs(l) + (l < 0); }
+  inline int Value(int l) const { return l > 0 ? value[l] : -value[-l]; }
+  inline vector<int> &Occ(int l){ return occ[Index(l)]; }
+
+  void EnsureVar(int v){
+    if (v < n) return;
+    n = v + 1;
+    value     .resize(n, 0);
+    eliminated.resize(n, false);
+    occ       .resize(2 * n);
+    mark      .resize(2 * n, 0);
+  }
+
+  // drop the ids of removed clauses
+  vector<int> &Clean(int l){
+    vector<int> &os = Occ(l);
+    size_t j = 0;
+    for (size_t i = 0; i < os.size(); i++) if (!removed[os[i]]) os[j++] = os[i];
+    os.resize(j);
+    return os;
+  }
+
+  void Assign(int l){
+    if (Value(l) == 1) return;
+    if (Value(l) == -1){ ok = false; return; }
+    value[abs(l)] = l > 0 ? 1 : -1;
+    units.push_back(l);
+    elim_stack.push_back(make_pair(l, vector<int>(1, l)));
+  }
+
+  void Touch(int id){
+    if (in_touched[id]) return;
+    in_touched[id] = true;
+    touched.push_back(id);
+  }
+
+  void RemoveClause(int id){
+    if (removed[id]) return;
+    removed[id] = true;
+    removed_clauses++;
+  }
+
+  bool AddClause(vector<int> c){
+    sort(c.begin(), c.end(), [](int a, int b){ return Index(a) < Index(b); });
+    c.erase(unique(c.begin(), c.end()), c.end());
+    size_t j = 0;
+    for (size_t i = 0; i < c.size(); i++){
+      if (i + 1 < c.size() && c[i] == -c[i + 1]) return ok;
+      if (Value(c[i]) == 1) return ok;
+      if (Value(c[i]) == 0) c[j++] = c[i];
+    }
+    c.resize(j);
+    if (c.empty()){
+      ok = false;
+    } else if (c.size() == 1){
+      Assign(c[0]);
+    } else {
+      int id = cls.size();
+      cls       .push_back(c);
+      removed   .push_back(false);
+      in_touched.push_back(false);
+      for (int l : c) Occ(l).push_back(id);
+      Touch(id);
+    }
+    return ok;
+  }
+
+  // remove the literal l from the clause id
+  void Strengthen(int id, int l){
+    vector<int> &c = cls[id];
+    c.erase(find(c.begin(), c.end(), l));
+    vector<int> &os = Occ(l);
+    os.erase(find(os.begin(), os.end(), id));
+    if (c.size() == 1){
+      Assign(c[0]);
+      RemoveClause(id);
+    } else {
+      Touch(id);
+    }
+  }
+
+  void Propagate(){
+    while (ok && !units.empty()){
+      int l = units.back();
+      units.pop_back();
+      for (int id : Occ(l)) RemoveClause(id);
+      Occ(l).clear();
+      vector<int> os = Clean(-l);
+      for (int id : os) if (!removed[id]) Strengthen(id, -l);
+    }
+  }
+
+  bool PureLiterals(){
+    bool changed = false;
+    for (int v = 1; v < n && ok; v++){
+      if (value[v] != 0 || eliminated[v]) continue;
+      bool pos = !Clean(v).empty(), neg = !Clean(-v).empty();
+      if (pos == neg) continue;
+      Assign(pos ? v : -v);
+      Propagate();
+      changed = true;
+    }
+    return changed;
+  }
+
+  // 0 if c subsumes d, x if c with one flipped literal subsumes d
+  // (then -x can be removed from d), -1 otherwise
+  int SubsumeCheck(const vector<int> &c, const vector<int> &d){
+    if (c.size() > d.size()) return -1;
+    stamp++;
+    for (int l : d) mark[Index(l)] = stamp;
+    int flip = 0;
+    for (int l : c){
+      if (mark[Index(l)] == stamp) continue;
+      if (flip == 0 && mark[Index(-l)] == stamp) flip = l;
+      else return -1;
+    }
+    return flip == 0 ? 0 : abs(flip);
+  }
+
+  // remove the clause id if another clause subsumes it
+  bool ForwardSubsumed(int id){
+    for (int l : cls[id]){
+      for (int d : Clean(l)){
+        if (d == id || cls[d].size() > cls[id].size()) continue;
+        if (SubsumeCheck(cls[d], cls[id]) == 0){
+          RemoveClause(id);
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  bool Subsume(){
+    bool changed = false;
+    while (ok && !touched.empty()){
+      int id = touched.back();
+      touched.pop_back();
+      in_touched[id] = false;
+      if (removed[id] || ForwardSubsumed(id)) continue;
+      // every clause subsumed or strengthened by c contains best or -best
+      int best = cls[id][0];
+      for (int l : cls[id])
+        if (Occ(l).size() + Occ(-l).size() < Occ(best).size() + Occ(-best).size()) best = l;
+      vector<int> cand = Clean(best);
+      vector<int> &neg = Clean(-best);
+      cand.insert(cand.end(), neg.begin(), neg.end());
+      for (int d : cand){
+        if (d == id || removed[d] || removed[id]) continue;
+        int r = SubsumeCheck(cls[id], cls[d]);
+        if (r < 0) continue;
+        if (r == 0){
+          RemoveClause(d);
+        } else {
+          int x = find(cls[d].begin(), cls[d].end(), r) != cls[d].end() ? r : -r;
+          Strengthen(d, x);
+          Propagate();
+        }
+        changed = true;
+        if (!ok) return changed;
+      }
+    }
+    return changed;
+  }
+
+  // resolvent of c and d on v; false if it is a tautology
+  bool Resolve(const vector<int> &c, const vector<int> &d, int v, vector<int> &out){
+    out.clear();
+    stamp++;
+    for (int l : c){
+      if (abs(l) == v) continue;
+      mark[Index(l)] = stamp;
+      out.push_back(l);
+    }
+    for (int l : d){
+      if (abs(l) == v || mark[Index(l)] == stamp) continue;
+      if (mark[Index(-l)] == stamp) return false;
+      out.push_back(l);
+    }
+    return true;
+  }
+
+  // eliminate v if it does not increase the number of clauses
+  bool TryEliminate(int v){
+    vector<int> pos = Clean(v), neg = Clean(-v);
+    if (pos.empty() || neg.empty() || pos.size() + neg.size() > occ_limit) return false;
+    vector<vector<int> > resolvents;
+    vector<int>          r;
+    for (int p : pos){
+      for (int q : neg){
+        if (!Resolve(cls[p], cls[q], v, r)) continue;
+        if (r.size() > resolvent_limit || resolvents.size() == pos.size() + neg.size())
+          return false;
+        resolvents.push_back(r);
+      }
+    }
+    for (int id : pos) elim_stack.push_back(make_pair( v, cls[id]));
+    for (int id : neg) elim_stack.push_back(make_pair(-v, cls[id]));
+    for (int id : pos) RemoveClause(id);
+    for (int id : neg) RemoveClause(id);
+    eliminated[v] = true;
+    eliminated_vars++;
+    for (auto &c : resolvents) if (!AddClause(c)) return true;
+    Propagate();
+    return true;
+  }
+
+  bool Eliminate(){
+    vector<pair<size_t, int> > vars;
+    for (int v = 1; v < n; v++)
+      if (value[v] == 0 && !eliminated[v])
+        vars.push_back(make_pair(Clean(v).size() * Clean(-v).size(), v));
+    sort(vars.begin(), vars.end());
+    bool changed = false;
+    for (auto &p : vars){
+      if (!ok) break;
+      int v = p.second;
+      if (value[v] != 0 || eliminated[v]) continue;
+      if (TryEliminate(v)){
+        changed = true;
+        Subsume();
+      }
+    }
+    return changed;
+  }
+
+public:
+  size_t occ_limit;          // skip variables with more occurrences
+  size_t resolvent_limit;    // skip variables producing longer resolvents
+  int    max_rounds;
+
+  Preprocessor() : occ_limit(16), resolvent_limit(20), max_rounds(3) {}
+
+  size_t NumEliminatedVars () const { return eliminated_vars; }
+  size_t NumRemovedClauses () const { return removed_clauses; }
+
+  bool Run(const vector<vector<int> > &cs, vector<vector<int> > &out){
+    n = 0;
+    ok = true;
+    stamp = 0;
+    eliminated_vars = removed_clauses = 0;
+    cls.clear(); removed.clear(); occ.clear(); value.clear(); eliminated.clear();
+    units.clear(); touched.clear(); in_touched.clear(); mark.clear(); elim_stack.clear();
+    for (auto &c : cs)
+      for (int l : c) EnsureVar(abs(l));
+    for (auto &c : cs) if (!AddClause(c)) return false;
+
+    Propagate();
+    for (int round = 0; ok && round < max_rounds; round++){
+      bool changed = PureLiterals();
+      changed |= Subsume();
+      changed |= Eliminate();
+      if (!changed) break;
+    }
+    out.clear();
+    if (!ok) return false;
+    for (size_t id = 0; id < cls.size(); id++)
+      if (!removed[id]) out.push_back(cls[id]);
+    return true;
+  }
+
+  void Extend(vector<bool> &model) const {
+    if ((int)model.size() < n) model.resize(n, false);
+    for (auto it = elim_stack.rbegin(); it != elim_stack.rend(); ++it){
+      bool sat = false;
+      for (int l : it->second) if (model[abs(l)] == (l > 0)) sat = true;
+      if (!sat) model[abs(it->first)] = it->first > 0;
+    }
+  }
+};
+#endif
@@ -1,8 +1,13 @@
 /***********************************************************
 CDCL-SAT solver for competitive programming
-- Conflict Driven Clause Learning
-- VSIDS
-- Watched Literals
+- Conflict Driven Clause Learning (with recursive clause minimization)
+- VSIDS (exponential decay, binary heap)
+- Watched Literals (with blocker literals, implicit binary watches)
+- Clause Arena (flat clause database with compacting GC)
+- Learnt Clause Deletion (LBD and activity based)
+- Restarts (Luby / glucose-style dynamic) with Phase Saving
+- Inprocessing (failed literal probing, equivalent literal substitution,
+  learnt clause vivification)
 
 each variable is represented by integer from 1 to V
 (where V is maximum absolute value in all clauses)
@@ -12,12 +17,82 @@ a negative literal ~x is represented by -x
 0 means an undefined literals (for implementation convenience)
 
 member method
-- bool Solve(vector<clause>) // return true if we find valid assignment
-- void AddClause(vector<int>)   // add a new clause
+- bool Solve(vector<clause>)    // return true if we find valid assignment
+- bool AddClause(vector<int>)   // add a new clause (also on a solved instance)
+- bool AddClause(int*, int*)    // same, without building a vector (dimacs.hpp)
+- bool Solve(vector<int>)       // solve incrementally under the assumptions
+- bool AddXor(vector<int>, bool)      // XOR of the literals is rhs
+- bool AddAtMost(vector<int>, int k)  // at most k of the literals are true
+- bool AddAtLeast(vector<int>, int k) // at least k of the literals are true
 member variables
-- vector<int> model  // a valid assignment when Solve() == true
+- vector<int> model     // a valid assignment when Solve() == true
+- vector<int> conflict  // failed assumptions when Solve(assumptions) == false
+- bool preprocess       // simplify the clauses given to Solve(vector<clause>)
+                        // by Preprocessor (see preprocessor.hpp). variables
+                        // eliminated there must not be used afterwards.
 
-this solver does not release allocated memory.
+all clauses live in a single arena of 32-bit words (header + inline literals)
+and are referred by 32-bit offsets. removed clauses are reclaimed by
+compacting the arena when the wasted words exceed a fraction of its size.
+learnt clauses are scored by LBD (number of distinct decision levels) and
+activity; glue clauses (LBD <= 2) are kept forever and the worse half of the
+others is deleted periodically.
+
+restart_policy selects NO_RESTART, LUBY_RESTART (luby(i) * luby_unit conflicts)
+or GLUCOSE_RESTART (restart when the recent LBD average is much worse than the
+global one, blocked while the trail is unusually long). decisions reuse the
+last value of each variable, so a restart does not lose the assignment.
+
+seed, random_var_freq and default_phase diversify solvers running in
+parallel (portfolio.hpp), which share clauses through learnt_callback and
+restart_callback + ImportClause() and stop when *terminate becomes true.
+
+when inprocess is set, the solver simplifies the formula at a restart once
+every inprocess_interval conflicts:
+- probing: a literal whose propagation fails is fixed to false
+- equivalent literals (one strongly connected component of the binary
+  implication graph) are replaced by one representative. the replaced
+  variables are still accepted by AddClause() / Solve(assumptions) and get
+  their values in model from the representative. the assumptions of a
+  running Solve() are mapped to the new representatives after each round.
+- vivification: a learnt clause l1 v ... v lk is shortened when propagating
+  ~l1, ~l2, ... already gives a conflict or makes a later literal true/false
+probing and vivification stop after inprocess_effort times the propagations
+done by the search since the previous round.
+
+when two_sat is set and every clause given to Solve(vector<clause>) has at
+most two literals, the formula is solved in O(V + E) by the strongly
+connected components of its implication graph (a CSR graph reused by the
+next call) instead of the search: x is true iff the component of x comes
+after the one of ~x in the topological order. the unit clauses are
+propagated on the graph first, so a formula refuted by them is answered
+without the SCC (which would otherwise lose to CDCL there). the clauses
+are put into the solver only when the incremental API is used afterwards.
+
+AddXor() and AddAtMost() / AddAtLeast() add constraints which are not
+translated into clauses (only with the incremental API; Solve(vector<clause>)
+starts from an empty formula).
+- XOR constraints form one matrix over GF(2) with a row of 64-bit words per
+  constraint, kept in reduced row echelon form whose basic variables are
+  unassigned. when a basic variable is assigned, an unassigned variable of
+  its row becomes basic instead. a row whose other variables are all
+  assigned implies its basic variable.
+- a cardinality constraint counts its true literals; when k are true the
+  others become false.
+the reason of such a literal is recorded as a snapshot (the row, or the k
+true literals) and made into a clause only when Analyze() asks for it.
+
+when proof is set, learnt and deleted clauses are logged as a DRAT proof
+(only for clauses: XOR and cardinality constraints are not supported).
+
+Stats() returns the counters of SatStats (accumulated over incremental
+Solve() calls). progress_callback is called every progress_interval
+conflicts. compile-time switches:
+- SAT_STATS=0    decisions are not counted and the progress callback is
+                 never called (the other counters drive the search)
+- SAT_PROFILE=1  measure the time spent in Bcp(), Analyze(), decisions and
+                 inprocessing
+                 (two clock reads per call, off by default)
 
 ***********************************************************/
 #ifndef GUARD_MINI2SAT
@@ -28,25 +103,158 @@ this solver does not release allocated memory.
 #include <vector>
 #include <cstdint>
 #include <algorithm>
-#include <set>
 #include <iostream>
+#include <cmath>
+#include <atomic>
+#include <functional>
+#include <chrono>
+#include "preprocessor.hpp"
+#include "drat.hpp"
+#include "../graph/strong-connected-components/strong_connected_components.hpp"
 
 using namespace std;
 
+#ifndef SAT_STATS
+#define SAT_STATS 1
+#endif
+#ifndef SAT_PROFILE
+#define SAT_PROFILE 0
+#endif
+
+struct SatStats{
+  uint64_t decisions;
+  uint64_t propagations;       // literals taken from the trail by Bcp()
+  uint64_t conflicts;
+  uint64_t restarts;
+  uint64_t learnt_literals;    // after minimization
+  uint64_t minimized_literals; // removed by minimization
+  uint64_t deleted_learnts;
+  uint64_t failed_literals;    // fixed by probing
+  uint64_t substituted_vars;   // replaced by equivalent literals
+  uint64_t vivified_clauses;   // shortened by vivification
+  uint64_t vivified_literals;  // removed by vivification
+  double   solve_time;         // seconds in Solve()
+  double   bcp_time;           // seconds in Bcp()      (SAT_PROFILE)
+  double   analyze_time;       // seconds in Analyze()  (SAT_PROFILE)
+  double   decide_time;        // seconds in decisions  (SAT_PROFILE)
+  double   inprocess_time;     // seconds in Inprocess() (SAT_PROFILE)
+  SatStats() : decisions(0), propagations(0), conflicts(0), restarts(0), learnt_literals(0),
+               minimized_literals(0), deleted_learnts(0), failed_literals(0),
+               substituted_vars(0), vivified_clauses(0), vivified_literals(0), solve_time(0),
+               bcp_time(0), analyze_time(0), decide_time(0), inprocess_time(0) {}
+};
+
+// adds the lifetime of the object to *t in seconds
+class SatTimer{
+  double                             *t;
+  chrono::steady_clock::time_point   start;
+public:
+  SatTimer(double *t) : t(t), start(chrono::steady_clock::now()) {}
+  ~SatTimer(){ *t += chrono::duration<double>(chrono::steady_clock::now() - start).count(); }
+};
+
+#if SAT_STATS
+#define SAT_COUNT(x) (stats.x++)
+#else
+#define SAT_COUNT(x) ((void)0)
+#endif
+#if SAT_PROFILE
+#define SAT_TIME(x) SatTimer sat_timer_##x(&stats.x)
+#else
+#define SAT_TIME(x) ((void)0)
+#endif
+
 class SatSolver{
   struct Lit{
     int x;
     Lit() : x(-1) { }
     Lit(int v, bool sign = false){ this->x = v * 2 + sign;}
     bool operator==(Lit p) const { return x == p.x; }
+    bool operator!=(Lit p) const { return x != p.x; }
     inline bool Sign() const { return x & 1; }
     inline int Var () const { return x >> 1; }
     inline int ToInt() const { return x; }
     friend inline Lit operator~(Lit p){ p.x ^= 1; return p; }
     friend inline bool operator<(Lit p, Lit q){ return p.x < q.x; }
   };
-  typedef vector<Lit>        clause;
-  typedef pair<clause*, Lit> Watcher;
+
+  typedef uint32_t CRef;
+  // a reason >= NativeTag (except CRefUndef) is NativeTag + an index of
+  // native_reasons, made into a clause by Reason()
+  enum : CRef { CRefUndef = UINT32_MAX, NativeTag = 1u << 31 };
+
+  // header word followed by size() literals in the same arena.
+  // learnt clauses have two more words (activity, lbd) after the literals.
+  struct Clause{
+    uint32_t sz       : 28;
+    uint32_t learnt   : 1;
+    uint32_t deleted  : 1;
+    uint32_t reloced  : 1;
+    uint32_t vivified : 1;      // already tried by Vivify()
+    inline int  size() const { return sz; }
+    inline Lit *begin() { return reinterpret_cast<Lit*>(this + 1); }
+    inline Lit *end  () { return begin() + sz; }
+    inline Lit &operator[](int i) { return begin()[i]; }
+    inline CRef Relocation() { return begin()[0].x; }
+    inline float    &Activity() { return *reinterpret_cast<float*>(end()); }
+    inline uint32_t &Lbd     () { return *(reinterpret_cast<uint32_t*>(end()) + 1); }
+  };
+
+  struct ClauseArena{
+    vector<uint32_t> mem;
+    size_t           wasted;
+    ClauseArena() : wasted(0) {}
+
+    static size_t Words(size_t size, bool learnt){
+      return (sizeof(Clause) + sizeof(Lit) * size) / sizeof(uint32_t) + (learnt ? 2 : 0);
+    }
+    inline Clause &operator[](CRef r){ return *reinterpret_cast<Clause*>(&mem[r]); }
+    inline size_t Size() const { return mem.size(); }
+
+    CRef Alloc(const Lit *lits, size_t size, bool learnt){
+      assert(mem.size() + Words(size, learnt) < NativeTag);
+      CRef r = mem.size();
+      mem.resize(mem.size() + Words(size, learnt));
+      Clause &c = (*this)[r];
+      c.sz       = size;
+      c.learnt   = learnt;
+      c.deleted  = 0;
+      c.reloced  = 0;
+      c.vivified = 0;
+      copy(lits, lits + size, c.begin());
+      if (learnt){
+        c.Activity() = 0;
+        c.Lbd()      = 0;
+      }
+      return r;
+    }
+    void Free(CRef r){
+      Clause &c = (*this)[r];
+      c.deleted = 1;
+      wasted   += Words(c.size(), c.learnt);
+    }
+    // move the clause r into "to" (only once) and update r to the new offset
+    void Reloc(CRef &r, ClauseArena &to){
+      Clause &c = (*this)[r];
+      if (c.reloced){ r = c.Relocation(); return; }
+      CRef nr = to.Alloc(c.begin(), c.size(), c.learnt);
+      if (c.learnt){
+        to[nr].Activity() = c.Activity();
+        to[nr].Lbd()      = c.Lbd();
+      }
+      to[nr].vivified = c.vivified;
+      c.reloced = 1;
+      c[0].x    = nr;
+      r         = nr;
+    }
+  };
+
+  struct Watcher{
+    CRef cref;
+    Lit  blocker;
+    Watcher() : cref(CRefUndef) {}
+    Watcher(CRef cref, Lit blocker) : cref(cref), blocker(blocker) {}
+  };
     
   struct LBool{
     uint8_t x;
@@ -55,73 +263,301 @@ class SatSolver{
     bool  operator!= (LBool b) const { return !(*this == b); }
     LBool operator^  (bool  b) const { return LBool(x^b); }
   };
+  // fixed size window keeping the sum of the last "cap" values
+  struct BoundedQueue{
+    vector<uint64_t> buf;
+    size_t           head, cnt;
+    uint64_t         sum;
+    BoundedQueue(size_t cap = 1) : buf(cap), head(0), cnt(0), sum(0) {}
+    void Push(uint64_t x){
+      if (cnt == buf.size()) sum -= buf[head];
+      else cnt++;
+      sum += x;
+      buf[head] = x;
+      if (++head == buf.size()) head = 0;
+    }
+    bool   Full() const { return cnt == buf.size(); }
+    double Avg () const { return cnt == 0 ? 0.0 : (double)sum / cnt; }
+    void   Clear(){ head = cnt = 0; sum = 0; }
+  };
+
+  // binary max-heap of variables ordered by activity
+  struct VarHeap{
+    const vector<double> *act;
+    vector<int>           heap;
+    vector<int>           index;   // position in heap or -1
+    VarHeap() : act(nullptr) {}
+    VarHeap(const vector<double> *act, int n) : act(act), index(n, -1) {}
+
+    inline bool Less(int x, int y) const { return (*act)[x] < (*act)[y]; }
+    inline bool Empty() const { return heap.empty(); }
+    inline bool Contains(int x) const { return index[x] >= 0; }
+
+    void Up(int i){
+      int x = heap[i];
+      while (i > 0 && Less(heap[(i - 1) / 2], x)){
+        heap[i] = heap[(i - 1) / 2];
+        index[heap[i]] = i;
+        i = (i - 1) / 2;
+      }
+      heap[i]  = x;
+      index[x] = i;
+    }
+    void Down(int i){
+      int x = heap[i], sz = heap.size();
+      while (2 * i + 1 < sz){
+        int c = 2 * i + 1;
+        if (c + 1 < sz && Less(heap[c], heap[c + 1])) c++;
+        if (!Less(x, heap[c])) break;
+        heap[i] = heap[c];
+        index[heap[i]] = i;
+        i = c;
+      }
+      heap[i]  = x;
+      index[x] = i;
+    }
+    void Insert(int x){
+      if (Contains(x)) return;
+      heap.push_back(x);
+      Up(heap.size() - 1);
+    }
+    // the activity of x has been increased
+    void Increased(int x){ if (Contains(x)) Up(index[x]); }
+    int RemoveMax(){
+      int x = heap[0];
+      heap[0] = heap.back();
+      index[heap[0]] = 0;
+      index[x] = -1;
+      heap.pop_back();
+      if (heap.size() > 1) Down(0);
+      return x;
+    }
+  };
+
+  // at most k of lits are true
+  struct Card{
+    vector<Lit> lits;
+    int         k;
+    int         count;             // true literals counted by Bcp()
+  };
+
+  struct NativeReason{
+    int    var;
+    bool   card;                   // the k true literals in card_pool, or
+    size_t offset;                 // a row of the matrix in xor_pool
+  };
+
   const LBool LFalse = LBool(0);
   const LBool LTrue  = LBool(1);
   const LBool LUndef = LBool(2);
     
   int             n;
+  bool            ok;              // false if the clauses are unsatisfiable
   size_t          qhead;
-  vector<clause*> reason;
+  vector<Lit>     assumptions;
+  vector<int>     assumption_ints; // as given to Solve()
+  vector<Lit>     add_buf;         // reused by AddClause(const int*, const int*)
+  vector<int>     imp_start, imp_adj, imp_fill;   // implication graph of a 2-CNF (CSR)
+  vector<bool>    imp_forced;      // implied by the unit clauses
+  StrongConnectedComponent imp_scc;
+  bool            two_sat_pending; // the formula is only in the implication graph
+  ClauseArena     arena;
+  vector<CRef>    clauses;
+  vector<CRef>    learnts;
+  vector<CRef>    reason;
   vector<LBool>   assign;
   vector<int>     level;
   vector<bool>    seen;
   vector<Lit>     trail;
   vector<int>     trail_lim;
   vector<vector<Watcher> > watch;
+  vector<vector<Watcher> > watch_bin; // blocker is the other literal
+  bool            has_native;      // XOR or cardinality constraints exist
+  size_t          native_head;     // trail literals counted by the native constraints
+  vector<pair<vector<int>, bool> > xors;  // variables and parity as given
+  bool            xor_dirty;       // the matrix has to be built again
+  int             xor_rows, xor_words;
+  vector<uint64_t> matrix;         // xor_rows rows of xor_words words
+  vector<uint8_t> xor_rhs;
+  vector<int>     xor_basic;       // basic column of each row
+  vector<int>     col_row;         // the row of a basic column or -1
+  vector<int>     col_var;
+  vector<int>     var_col;         // -1 if not in the matrix
+  vector<uint64_t> col_assigned;   // bit sets of the counted columns
+  vector<uint64_t> col_value;
+  vector<char>    row_touched;
+  vector<Card>    cards;
+  vector<vector<int> > card_occ;   // cards containing each literal
+  vector<bool>    native_var;      // never substituted by inprocessing
+  vector<NativeReason> native_reasons;  // in trail order
+  vector<uint64_t> xor_pool;
+  vector<Lit>     card_pool;
+  vector<pair<int, CRef> > explained;   // clauses made by Reason()
+  CRef            native_confl;    // the last conflict clause of a native constraint
+  vector<Lit>     native_buf;
   double          var_inc;
+  double          var_decay;
   vector<double>  activity;
-  set<pair<double, int> > order;
+  VarHeap         order;
+  size_t          simp_trail;      // trail size at the last Simplify()
+  double          garbage_frac;    // compact the arena above this wasted ratio
+  double          cla_inc;
+  vector<uint64_t> level_stamp;    // for counting distinct levels in Lbd()
+  uint64_t        stamp;
+  SatStats        stats;
+  uint64_t        next_reduce;     // reduce the learnt clauses at this conflict
+  uint64_t        reduce_interval; // grows by reduce_inc after every reduction
+  uint64_t        reduce_inc;
+  vector<Lit>     analyze_stack;
+  vector<Lit>     analyze_toclear;
+  vector<bool>    phase;           // saved sign of the last assignment
+  uint64_t        restart_conflicts; // conflicts since the last restart
+  BoundedQueue    lbd_queue;
+  BoundedQueue    trail_queue;
+  double          lbd_sum;         // sum of LBD over all learnt clauses
+  uint64_t        rng;
+  bool            interrupted;
+  size_t          proof_units;     // level 0 literals already in the proof
+  vector<Lit>     repr;            // equivalent literal of each variable
+  int             num_substituted;
+  uint64_t        next_inprocess;  // run Inprocess() at a restart after this conflict
+  uint64_t        inprocess_props; // propagations done by Inprocess()
+  uint64_t        search_props;    // propagations of the search at the last Inprocess()
+  int             probe_next;      // the variable to probe first
+  vector<int>     export_buf;
     
   inline LBool Value(Lit p) const { return assign[p.Var()] ^ p.Sign(); }
   inline int DecisionLevel(){ return trail_lim.size();}
   
   void IncreaseActivity(int x){
-    auto p = make_pair(activity[x], x);
-    activity[x] += var_inc;
-    if (order.erase(p) == 1) order.insert(make_pair(activity[x], x));
-    if (activity[x] <= 1e100) return;
-        
-    auto tmp = order;       // rescale
-    order.clear();
-    for (auto &p : tmp) order.insert(make_pair(p.first * 1e-100, p.second));
-    for (int v = 1; v < n; v++) activity[v] *= 1e-100;
-    var_inc *= 1e-100;
+    if ((activity[x] += var_inc) > 1e100){
+      // rescale; the order of the heap does not change
+      for (int v = 1; v < n; v++) activity[v] *= 1e-100;
+      var_inc *= 1e-100;
+    }
+    order.Increased(x);
   }
     
+  // xorshift64
+  inline uint64_t Random(){
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    return rng;
+  }
+
   int SelectVariable(){
-    while (!order.empty()){
-      auto p = *order.rbegin();
-      order.erase(p);
-      if (Value(Lit(p.second)) == LUndef) return p.second;
+    if (random_var_freq > 0 && !order.Empty() &&
+        (Random() % 1000000) < random_var_freq * 1000000){
+      int x = order.heap[Random() % order.heap.size()];
+      if (Value(Lit(x)) == LUndef && !Substituted(x)) return x;
+    }
+    while (!order.Empty()){
+      int x = order.RemoveMax();
+      if (Value(Lit(x)) == LUndef && !Substituted(x)) return x;
     }
     return -1;
   }
     
-  bool Init(const vector<vector<int> > &cs){
-    vector<clause> cls(cs.size());
+  void Init(){
     n = qhead = 0;
-    for (size_t i = 0; i < cs.size(); i++){
-      for (auto l : cs[i]) {
-        cls[i].push_back(l > 0 ? Lit(l) : ~Lit(-l));
-        n = max(n, abs(l) + 1);
-      }
-    }
+    ok = true;
     trail.clear();
-    order.clear();
     trail_lim.clear();
-    assign   = vector<LBool>(n, LUndef);
-    level    = vector<int>(n, -1);
-    reason   = vector<clause*>(n, nullptr);
-    seen     = vector<bool>(n, false);
-    activity = vector<double>(n, 0.0);
-    watch    = vector<vector<Watcher> > (n * 2);
-    var_inc = 1.01;
-    for (int v = 1; v < n; v++) order.insert(make_pair(0.0, v));
-    for (auto &c : cls) if (!AddClause(c, false)) return false;
-    return true;
+    clauses.clear();
+    learnts.clear();
+    assumptions.clear();
+    arena    = ClauseArena();
+    assign   .clear();
+    level    .clear();
+    reason   .clear();
+    seen     .clear();
+    activity .clear();
+    phase    .clear();
+    order    = VarHeap(&activity, 0);
+    watch    .clear();
+    watch_bin.clear();
+    level_stamp.clear();
+    has_native  = false;
+    native_head = 0;
+    xors.clear();
+    xor_dirty = false;
+    xor_rows  = xor_words = 0;
+    matrix .clear();
+    col_var.clear();
+    var_col.clear();
+    cards  .clear();
+    card_occ.clear();
+    native_var.clear();
+    native_reasons.clear();
+    xor_pool .clear();
+    card_pool.clear();
+    explained.clear();
+    native_confl = CRefUndef;
+    two_sat_pending = false;
+    var_inc   = 1.0;
+    var_decay = 0.95;
+    cla_inc = 1.0;
+    stamp   = 0;
+    simp_trail   = 0;
+    garbage_frac = 0.20;
+    stats        = SatStats();
+    reduce_interval = 2000;
+    reduce_inc      = 300;
+    next_reduce     = reduce_interval;
+    restart_conflicts = 0;
+    lbd_queue   = BoundedQueue(50);
+    trail_queue = BoundedQueue(5000);
+    lbd_sum     = 0;
+    rng         = 0x9E3779B97F4A7C15ULL * (seed + 1);
+    interrupted = false;
+    proof_units = 0;
+    repr.clear();
+    num_substituted = 0;
+    next_inprocess  = inprocess_interval;
+    inprocess_props = search_props = 0;
+    probe_next      = 1;
+  }
+
+  // make variables up to v available
+  void EnsureVar(int v){
+    if (v < n) return;
+    int old = n;
+    n = v + 1;
+    assign   .resize(n, LUndef);
+    level    .resize(n, -1);
+    reason   .resize(n, CRefUndef);
+    seen     .resize(n, false);
+    activity .resize(n, 0.0);
+    phase    .resize(n, !default_phase);
+    repr     .resize(n);
+    order.index.resize(n, -1);
+    watch    .resize(n * 2);
+    watch_bin.resize(n * 2);
+    card_occ .resize(n * 2);
+    var_col  .resize(n, -1);
+    native_var.resize(n, false);
+    for (int x = max(old, 1); x < n; x++){
+      repr[x] = Lit(x);
+      if (seed != 0) activity[x] = (Random() % 1000) * 1e-5;
+      order.Insert(x);
+    }
+  }
+
+  Lit ToLit(int l){
+    EnsureVar(abs(l));
+    return l > 0 ? repr[l] : ~repr[-l];
+  }
+
+  inline bool Substituted(int x) const { return repr[x] != Lit(x); }
+
+  // the assumptions of Solve() through repr, again after every substitution
+  void MapAssumptions(){
+    assumptions.clear();
+    for (int l : assumption_ints) assumptions.push_back(ToLit(l));
   }
     
-  void Assign(Lit p, clause *c){
+  void Assign(Lit p, CRef c){
     assert(Value(p) != LFalse);
     if (Value(p) == LUndef){
       assign[p.Var()] = LBool(!p.Sign());
@@ -131,93 +567,1037 @@ class SatSolver{
     }
   }
     
-  void CancelUntil(int level){
+  void CancelUntil(int level, bool save_phase = true){
+    if (DecisionLevel() <= level) return;
+    if (native_head > (size_t)trail_lim[level]) UndoNative(trail_lim[level]);
     for (int c = trail.size() - 1; c >= trail_lim[level]; c--){
       int x     = trail[c].Var();
       assign[x] = LUndef;
-      pair<double, int> p (activity[x], x);
-      if (order.count(p) == 0){
-        order.insert(p);
-      }
+      if (save_phase) phase[x] = trail[c].Sign();
+      order.Insert(x);
     }
     trail.resize(trail_lim[level]);
     trail_lim.resize(level);
     qhead = trail.size();
+    if (!native_reasons.empty() || !explained.empty()) PopNativeReasons();
   }
     
-  void Analyze(clause *confl, vector<Lit> &out, int &bt_level){
+  void Analyze(CRef confl, vector<Lit> &out, int &bt_level){
     int pathC    = 0;
     int index    = trail.size() - 1;
     Lit p        = Lit();
     bt_level = 0;
     out.push_back(p);
     do{
-      assert(confl != NULL);
-      for (Lit q : *confl){
+      assert(confl != CRefUndef);
+      Clause &c = arena[confl];
+      if (c.learnt){
+        IncreaseClauseActivity(c);
+        if (c.Lbd() > 2){
+          uint32_t lbd = Lbd(c.begin(), c.end());
+          if (lbd + 1 < c.Lbd()) c.Lbd() = lbd;
+        }
+      }
+      for (Lit q : c){
         if (p == q || seen[q.Var()] || level[q.Var()] == 0) continue;
         IncreaseActivity(q.Var());
         seen[q.Var()] = true;
         if (level[q.Var()] >= DecisionLevel())
           pathC++;
-        else{
+        else
           out.push_back(q);
-          bt_level = max(bt_level, level[q.Var()]);
-        }
       }
       while (!seen[trail[index--].Var()]);
       p     = trail[index + 1];
-      confl = reason[p.Var()];
+      confl = Reason(p.Var());
       seen[p.Var()] = 0;
     }while (--pathC > 0);
     out[0] = ~p;
-    for (auto l : out) seen[l.Var()] = false;
+
+    // drop the literals implied by the other literals of the clause
+    uint32_t abstract_levels = 0;
+    for (size_t i = 1; i < out.size(); i++) abstract_levels |= AbstractLevel(out[i].Var());
+    analyze_toclear = out;
+    size_t j = 1;
+    for (size_t i = 1; i < out.size(); i++)
+      if (reason[out[i].Var()] == CRefUndef || !LitRedundant(out[i], abstract_levels))
+        out[j++] = out[i];
+    stats.learnt_literals    += j;
+    stats.minimized_literals += out.size() - j;
+    out.resize(j);
+    for (auto l : analyze_toclear) seen[l.Var()] = false;
+
+    bt_level = 0;
+    for (size_t i = 1; i < out.size(); i++) bt_level = max(bt_level, level[out[i].Var()]);
+  }
+
+  inline uint32_t AbstractLevel(int x) const { return 1u << (level[x] & 31); }
+
+  // true if p is implied by literals marked as seen (the learnt clause),
+  // following the reasons. the abstraction of decision levels prunes early.
+  bool LitRedundant(Lit p, uint32_t abstract_levels){
+    analyze_stack.clear();
+    analyze_stack.push_back(p);
+    size_t top = analyze_toclear.size();
+    while (!analyze_stack.empty()){
+      int x = analyze_stack.back().Var();
+      analyze_stack.pop_back();
+      for (Lit q : arena[Reason(x)]){
+        int y = q.Var();
+        if (y == x || seen[y] || level[y] == 0) continue;
+        if (reason[y] != CRefUndef && (AbstractLevel(y) & abstract_levels) != 0){
+          seen[y] = true;
+          analyze_stack  .push_back(q);
+          analyze_toclear.push_back(q);
+        } else {
+          for (size_t i = top; i < analyze_toclear.size(); i++)
+            seen[analyze_toclear[i].Var()] = false;
+          analyze_toclear.resize(top);
+          return false;
+        }
+      }
+    }
+    return true;
   }
     
-  bool AddClause(const vector<Lit> &lits, bool learnt){
-    clause *c = new clause(lits.begin(), lits.end());
+  // collect the assumptions that imply ~p (p is a falsified assumption)
+  void AnalyzeFinal(Lit p, vector<Lit> &out){
+    out.clear();
+    out.push_back(p);
+    if (DecisionLevel() == 0) return;
+    seen[p.Var()] = true;
+    for (int i = trail.size() - 1; i >= trail_lim[0]; i--){
+      int x = trail[i].Var();
+      if (!seen[x]) continue;
+      if (reason[x] == CRefUndef){
+        out.push_back(trail[i]);
+      } else {
+        for (Lit q : arena[Reason(x)])
+          if (q.Var() != x && level[q.Var()] > 0) seen[q.Var()] = true;
+      }
+      seen[x] = false;
+    }
+    seen[p.Var()] = false;
+  }
+
+  void IncreaseClauseActivity(Clause &c){
+    if ((c.Activity() += cla_inc) <= 1e20) return;
+    for (CRef cr : learnts) arena[cr].Activity() *= 1e-20;
+    cla_inc *= 1e-20;
+  }
+
+  // literal block distance: the number of distinct decision levels
+  uint32_t Lbd(const Lit *begin, const Lit *end){
+    uint32_t res = 0;
+    if (level_stamp.size() <= (size_t)DecisionLevel())
+      level_stamp.resize(DecisionLevel() + 1, 0);
+    stamp++;
+    for (const Lit *l = begin; l != end; l++){
+      int lv = level[l->Var()];
+      if (level_stamp[lv] != stamp){
+        level_stamp[lv] = stamp;
+        res++;
+      }
+    }
+    return res;
+  }
+
+  // sort and drop duplicated and false literals (at level 0).
+  // return false if the clause is satisfied or a tautology.
+  bool Normalize(vector<Lit> &lits){
+    sort(lits.begin(), lits.end());
+    for (size_t i = 0; i + 1 < lits.size(); i++)
+      if (lits[i] == ~lits[i + 1]) return false;
+    size_t j = 0;
+    for (auto l : lits) if (Value(l) == LTrue) return false;
+    for (size_t i = 0; i < lits.size(); i++)
+      if (Value(lits[i]) != LFalse && (j == 0 || lits[i] != lits[j - 1]))
+        lits[j++] = lits[i];
+    lits.resize(j);
+    return true;
+  }
+
+  void Attach(CRef cr){
+    Clause &c = arena[cr];
+    vector<vector<Watcher> > &ws = c.size() == 2 ? watch_bin : watch;
+    ws[(~c[0]).ToInt()].push_back(Watcher(cr, c[1]));
+    ws[(~c[1]).ToInt()].push_back(Watcher(cr, c[0]));
+  }
+
+  // lits may be reordered and shrunk
+  bool AddClause(vector<Lit> &lits, bool learnt, uint32_t lbd = 0){
     if (!learnt){
-      sort(c->begin(), c->end());
-      for (size_t i = 0; i + 1 < c->size(); i++)
-        if ((*c)[i] == ~(*c)[i + 1]) return true;
-      size_t j = 0;
-      for (auto l : *c) if (Value(l) == LTrue) return true;
-      for (auto l : *c) if (Value(l) != LFalse) (*c)[j++] = l;
-      c->resize(j);
-    }
-    if (c->size() == 0) {
+      size_t size = lits.size();
+      if (!Normalize(lits)) return true;
+      // a shortened input clause is RUP and has to be in the proof
+      if (proof != nullptr && lits.size() != size && !lits.empty())
+        LogClause(lits.data(), lits.data() + lits.size(), false);
+    }
+    if (lits.size() == 0) {
       return false;
-    } else if (c->size() == 1){ 
-      Assign(c->at(0), nullptr);
+    } else if (lits.size() == 1){ 
+      Assign(lits[0], CRefUndef);
     } else {
       if (learnt){
-        Assign(c->at(0), c);
-        for (size_t i = 2; i < c->size(); i++)
-          if (level[(*c)[i].Var()] > level[(*c)[1].Var()])
-            swap((*c)[1], (*c)[i]);
+        for (size_t i = 2; i < lits.size(); i++)
+          if (level[lits[i].Var()] > level[lits[1].Var()])
+            swap(lits[1], lits[i]);
+      }
+      CRef cr = arena.Alloc(lits.data(), lits.size(), learnt);
+      (learnt ? learnts : clauses).push_back(cr);
+      if (learnt){
+        arena[cr].Lbd() = lbd;
+        IncreaseClauseActivity(arena[cr]);
+        Assign(lits[0], cr);
+      }
+      Attach(cr);
+    }
+    return true;
+  }
+
+  // a long clause can be the reason of its first literal only, but a binary
+  // clause is never reordered by Bcp() and may imply either literal
+  inline bool Locked(CRef cr){
+    Clause &c = arena[cr];
+    for (int i = 0; i < 2; i++)
+      if (Value(c[i]) == LTrue && reason[c[i].Var()] == cr) return true;
+    return false;
+  }
+
+  void LogClause(const Lit *begin, const Lit *end, bool deletion){
+    proof->Begin(deletion);
+    for (const Lit *q = begin; q != end; q++) proof->Push(q->Sign() ? -q->Var() : q->Var());
+    proof->End();
+  }
+
+  // the formula is unsatisfiable; the proof ends with the empty clause
+  void SetUnsat(){
+    if (ok && proof != nullptr) LogClause(nullptr, nullptr, false);
+    ok = false;
+  }
+
+  // watchers of removed clauses are dropped lazily by PurgeWatches()
+  void RemoveClause(CRef cr){
+    Clause &c = arena[cr];
+    if (proof != nullptr) LogClause(c.begin(), c.end(), true);
+    for (int i = 0; i < 2; i++)
+      if (Value(c[i]) == LTrue && reason[c[i].Var()] == cr) reason[c[i].Var()] = CRefUndef;
+    arena.Free(cr);
+  }
+
+  void PurgeWatches(){
+    for (auto *wss : {&watch, &watch_bin}){
+      for (auto &ws : *wss){
+        size_t j = 0;
+        for (size_t i = 0; i < ws.size(); i++)
+          if (!arena[ws[i].cref].deleted) ws[j++] = ws[i];
+        ws.resize(j);
+      }
+    }
+  }
+
+  bool Satisfied(CRef cr){
+    for (Lit l : arena[cr]) if (Value(l) == LTrue) return true;
+    return false;
+  }
+
+  void RemoveSatisfied(vector<CRef> &cs){
+    size_t j = 0;
+    for (size_t i = 0; i < cs.size(); i++){
+      if (Satisfied(cs[i])) RemoveClause(cs[i]);
+      else cs[j++] = cs[i];
+    }
+    cs.resize(j);
+  }
+
+  // keep glue and locked clauses, delete the worse half of the others
+  void ReduceDB(){
+    auto worse = [this](CRef a, CRef b){
+      Clause &x = arena[a], &y = arena[b];
+      if (x.Lbd() != y.Lbd()) return x.Lbd() > y.Lbd();
+      return x.Activity() < y.Activity();
+    };
+    sort(learnts.begin(), learnts.end(), worse);
+    size_t j = 0, limit = learnts.size() / 2;
+    for (size_t i = 0; i < learnts.size(); i++){
+      CRef cr = learnts[i];
+      if (i < limit && arena[cr].Lbd() > 2 && !Locked(cr)){
+        RemoveClause(cr);
+        stats.deleted_learnts++;
+      } else {
+        learnts[j++] = cr;
+      }
+    }
+    learnts.resize(j);
+    PurgeWatches();
+    CheckGarbage();
+  }
+
+  void CheckGarbage(){
+    if (arena.wasted > arena.Size() * garbage_frac) GarbageCollect();
+  }
+
+  // compact the arena; every live CRef has to be relocated here
+  void GarbageCollect(){
+    ClauseArena to;
+    to.mem.reserve(arena.Size() - arena.wasted);
+    for (auto *wss : {&watch_bin, &watch})
+      for (auto &ws : *wss)
+        for (auto &w : ws) arena.Reloc(w.cref, to);
+    for (Lit p : trail){
+      CRef &r = reason[p.Var()];
+      if (r >= NativeTag) continue;        // also CRefUndef
+      if (arena[r].deleted) r = CRefUndef;
+      else arena.Reloc(r, to);
+    }
+    for (auto &cr : clauses) arena.Reloc(cr, to);
+    for (auto &cr : learnts) arena.Reloc(cr, to);
+    for (auto &e : explained) arena.Reloc(e.second, to);
+    native_confl = CRefUndef;               // not needed any more
+    swap(arena, to);
+  }
+
+  // the reasons of the level 0 literals may be removed after this
+  void LogUnits(){
+    for (; proof_units < trail.size(); proof_units++)
+      LogClause(&trail[proof_units], &trail[proof_units] + 1, false);
+  }
+
+  // remove clauses satisfied at the top level
+  void Simplify(){
+    assert(DecisionLevel() == 0);
+    if (trail.size() == simp_trail) return;
+    if (proof != nullptr) LogUnits();
+    RemoveSatisfied(learnts);
+    RemoveSatisfied(clauses);
+    PurgeWatches();
+    CheckGarbage();
+    simp_trail = trail.size();
+  }
+
+  // 1, 1, 2, 1, 1, 2, 4, 1, 1, 2, 1, 1, 2, 4, 8, ...
+  static double Luby(double y, uint64_t x){
+    uint64_t size = 1, seq = 0;
+    while (size < x + 1){ seq++; size = 2 * size + 1; }
+    while (size - 1 != x){
+      size = (size - 1) >> 1;
+      seq--;
+      x = x % size;
+    }
+    return pow(y, seq);
+  }
+
+  // called after each conflict
+  void UpdateRestart(uint32_t lbd){
+    restart_conflicts++;
+    lbd_queue.Push(lbd);
+    lbd_sum += lbd;
+    // block the restart when the trail is much longer than usual
+    if (restart_policy == GLUCOSE_RESTART && stats.conflicts > 10000 && lbd_queue.Full() &&
+        trail.size() > 1.4 * trail_queue.Avg())
+      lbd_queue.Clear();
+    trail_queue.Push(trail.size());
+  }
+
+  bool NeedRestart(){
+    switch (restart_policy){
+    case LUBY_RESTART:
+      return restart_conflicts >= Luby(2, stats.restarts) * luby_unit;
+    case GLUCOSE_RESTART:
+      return lbd_queue.Full() && lbd_queue.Avg() * 0.8 > lbd_sum / stats.conflicts;
+    default:
+      return false;
+    }
+  }
+
+  void Restart(){
+    CancelUntil(0);
+    stats.restarts++;
+    restart_conflicts = 0;
+    lbd_queue.Clear();
+    if (restart_callback) restart_callback();
+    if (inprocess && ok && stats.conflicts >= next_inprocess){
+      Inprocess();
+      if (num_substituted > 0) MapAssumptions();
+    }
+  }
+
+  // replace each clause by the literals given for it, which have to be
+  // implied by the current formula. all new clauses are added before the old
+  // ones are removed, so each of them is RUP in the proof.
+  // false if the formula became unsatisfiable.
+  bool Rewrite(vector<pair<CRef, vector<Lit> > > &changes, bool vivified){
+    for (auto &ch : changes){
+      Clause     &old    = arena[ch.first];
+      bool        learnt = old.learnt;
+      uint32_t    lbd    = learnt ? old.Lbd() : 0;
+      float       act    = learnt ? old.Activity() : 0;
+      vector<Lit> &lits  = ch.second;
+      if (!Normalize(lits)) continue;            // satisfied or a tautology
+      if (lits.empty()){
+        SetUnsat();
+        return false;
+      }
+      if (proof != nullptr) LogClause(lits.data(), lits.data() + lits.size(), false);
+      if (lits.size() == 1){
+        Assign(lits[0], CRefUndef);
+        continue;
+      }
+      CRef    cr = arena.Alloc(lits.data(), lits.size(), learnt);
+      Clause &c  = arena[cr];
+      c.vivified = vivified;
+      if (learnt){
+        c.Lbd()      = min<uint32_t>(lbd, lits.size() - 1);
+        c.Activity() = act;
+      }
+      (learnt ? learnts : clauses).push_back(cr);
+      Attach(cr);
+    }
+    if (proof != nullptr) LogUnits();
+    for (auto &ch : changes) RemoveClause(ch.first);
+    auto removed = [this](CRef cr){ return arena[cr].deleted == 1; };
+    clauses.erase(remove_if(clauses.begin(), clauses.end(), removed), clauses.end());
+    learnts.erase(remove_if(learnts.begin(), learnts.end(), removed), learnts.end());
+    PurgeWatches();
+    if (Bcp() != CRefUndef){
+      SetUnsat();
+      return false;
+    }
+    CheckGarbage();
+    return true;
+  }
+
+  // fix ~p for every literal p whose propagation gives a conflict
+  bool Probe(uint64_t budget){
+    uint64_t start = stats.propagations;
+    for (int k = 1; k < n && stats.propagations - start < budget; k++){
+      int x = probe_next;
+      probe_next = probe_next + 1 < n ? probe_next + 1 : 1;
+      for (int sign = 0; sign < 2; sign++){
+        Lit p = Lit(x, sign);
+        // only a literal with binary implications can fail
+        if (Value(p) != LUndef || watch_bin[p.ToInt()].empty()) continue;
+        trail_lim.push_back(trail.size());
+        Assign(p, CRefUndef);
+        CRef confl = Bcp();
+        CancelUntil(0, false);
+        if (confl == CRefUndef) continue;
+        stats.failed_literals++;
+        Lit q = ~p;
+        if (proof != nullptr) LogClause(&q, &q + 1, false);
+        Assign(q, CRefUndef);
+        if (Bcp() != CRefUndef){
+          SetUnsat();
+          return false;
+        }
       }
-      watch[(~(*c)[0]).ToInt()].push_back(Watcher(c, (*c)[1]));
-      watch[(~(*c)[1]).ToInt()].push_back(Watcher(c, (*c)[0]));
     }
     return true;
   }
 
-  int bcp_count;
-  clause *Bcp(){
-    clause *confl = NULL;
+  // Tarjan's algorithm on the binary implication graph of the unassigned
+  // literals (p -> q for each binary clause ~p v q). every literal of a
+  // component is replaced by the one with the smallest variable. variables
+  // of XOR and cardinality constraints are never replaced.
+  bool SubstituteEquivalences(){
+    int           N = 2 * n;
+    vector<int>   index(N, -1), low(N, 0), comp(N, -1);
+    vector<int>   stack, call;
+    vector<size_t> iter(N, 0);
+    vector<Lit>   to(N, Lit());
+    int           counter = 0, num_comps = 0;
+    for (int s = 2; s < N; s++){
+      if (index[s] >= 0 || assign[s >> 1] != LUndef || Substituted(s >> 1)) continue;
+      index[s] = low[s] = counter++;
+      stack.push_back(s);
+      call .push_back(s);
+      while (!call.empty()){
+        int v = call.back();
+        const vector<Watcher> &ws = watch_bin[v];
+        if (iter[v] < ws.size()){
+          int w = ws[iter[v]++].blocker.ToInt();
+          if (assign[w >> 1] != LUndef) continue;
+          if (index[w] < 0){
+            index[w] = low[w] = counter++;
+            stack.push_back(w);
+            call .push_back(w);
+          } else if (comp[w] < 0){
+            low[v] = min(low[v], index[w]);
+          }
+          continue;
+        }
+        call.pop_back();
+        if (!call.empty()) low[call.back()] = min(low[call.back()], low[v]);
+        if (low[v] != index[v]) continue;
+        // pop the component of v
+        size_t begin = stack.size();
+        Lit    rep   = Lit(v >> 1, v & 1);
+        auto better = [this](int x, int y){
+          return native_var[x] != native_var[y] ? native_var[x] : x < y;
+        };
+        do{
+          begin--;
+          comp[stack[begin]] = num_comps;
+          if (better(stack[begin] >> 1, rep.Var())) rep = Lit(stack[begin] >> 1, stack[begin] & 1);
+        }while (stack[begin] != v);
+        for (size_t i = begin; i < stack.size(); i++){
+          if (comp[stack[i] ^ 1] == num_comps){      // p and ~p are equivalent
+            SetUnsat();
+            return false;
+          }
+          if (!native_var[stack[i] >> 1]) to[stack[i]] = rep;
+        }
+        stack.resize(begin);
+        num_comps++;
+      }
+    }
+
+    vector<bool> replaced(n, false);
+    bool         found = false;
+    for (int x = 1; x < n; x++){
+      Lit r = to[Lit(x).ToInt()];
+      if (r == Lit() || r.Var() == x) continue;
+      replaced[x] = found = true;
+      stats.substituted_vars++;
+      num_substituted++;
+    }
+    if (!found) return true;
+
+    vector<pair<CRef, vector<Lit> > > changes;
+    for (auto *cs : {&clauses, &learnts}){
+      for (CRef cr : *cs){
+        Clause &c = arena[cr];
+        bool    hit = false;
+        for (Lit l : c) hit |= replaced[l.Var()];
+        if (!hit) continue;
+        vector<Lit> lits;
+        for (Lit l : c) lits.push_back(replaced[l.Var()] ? to[l.ToInt()] : l);
+        changes.push_back(make_pair(cr, lits));
+      }
+    }
+    // variables replaced before now follow their representatives
+    for (int x = 1; x < n; x++){
+      Lit r = repr[x];
+      if (replaced[r.Var()]) repr[x] = to[r.ToInt()];
+    }
+    return Rewrite(changes, false);
+  }
+
+  // shorten learnt clauses by propagating the negation of their literals
+  bool Vivify(uint64_t budget){
+    vector<CRef> cands;
+    for (CRef cr : learnts)
+      if (!arena[cr].vivified && arena[cr].size() > 2 && !Satisfied(cr)) cands.push_back(cr);
+    sort(cands.begin(), cands.end(), [this](CRef a, CRef b){
+        Clause &x = arena[a], &y = arena[b];
+        if (x.Lbd() != y.Lbd()) return x.Lbd() < y.Lbd();
+        return x.Activity() > y.Activity();
+      });
+    uint64_t start = stats.propagations;
+    vector<pair<CRef, vector<Lit> > > changes;
+    vector<Lit> lits, kept;
+    for (CRef cr : cands){
+      if (stats.propagations - start >= budget) break;
+      Clause &c = arena[cr];
+      c.vivified = 1;
+      lits.assign(c.begin(), c.end());    // Bcp() reorders c
+      kept.clear();
+      for (Lit l : lits){
+        LBool v = Value(l);
+        if (v == LFalse) continue;         // implied false by the others
+        kept.push_back(l);
+        if (v == LTrue) break;             // implied true by the others
+        trail_lim.push_back(trail.size());
+        Assign(~l, CRefUndef);
+        if (Bcp() != CRefUndef) break;
+      }
+      CancelUntil(0, false);
+      if (kept.size() == lits.size()) continue;
+      stats.vivified_clauses++;
+      stats.vivified_literals += lits.size() - kept.size();
+      changes.push_back(make_pair(cr, kept));
+    }
+    return changes.empty() || Rewrite(changes, true);
+  }
+
+  void Inprocess(){
+    SAT_TIME(inprocess_time);
+    uint64_t start  = stats.propagations;
+    uint64_t search = start - inprocess_props;
+    uint64_t budget = (search - search_props) * inprocess_effort;
+    search_props   = search;
+    next_inprocess = stats.conflicts + inprocess_interval;
+    if (Bcp() != CRefUndef){                  // units imported at the restart
+      SetUnsat();
+      return;
+    }
+    Simplify();
+    if (Probe(budget)){
+      Simplify();
+      if (SubstituteEquivalences()){
+        Simplify();
+        Vivify(budget);
+      }
+    }
+    inprocess_props += stats.propagations - start;
+  }
+
+  // ---- XOR and cardinality constraints ----
+
+  inline uint64_t *Row(int r){ return &matrix[(size_t)r * xor_words]; }
+  static inline bool Bit(const uint64_t *a, int c){ return a[c >> 6] >> (c & 63) & 1; }
+
+  // a clause in the arena which is not attached (a reason or a conflict)
+  CRef NativeClause(const vector<Lit> &lits){
+    return arena.Alloc(lits.data(), lits.size(), false);
+  }
+
+  CRef NativeConflict(const vector<Lit> &lits){
+    if (native_confl != CRefUndef) arena.Free(native_confl);
+    return native_confl = NativeClause(lits);
+  }
+
+  // p and the false literals of the variables in the row
+  void RowLiterals(const uint64_t *row, Lit p, vector<Lit> &out){
+    out.clear();
+    if (p != Lit()) out.push_back(p);
+    for (int w = 0; w < xor_words; w++){
+      for (uint64_t b = row[w]; b != 0; b &= b - 1){
+        int x = col_var[w * 64 + __builtin_ctzll(b)];
+        if (x != p.Var()) out.push_back(Lit(x, assign[x] == LTrue));
+      }
+    }
+  }
+
+  // the clause form of a native reason, made on the first request
+  CRef Reason(int x){
+    CRef r = reason[x];
+    if (r < NativeTag || r == CRefUndef) return r;
+    const NativeReason &nr = native_reasons[r - NativeTag];
+    Lit p = Lit(x, assign[x] == LFalse);
+    if (nr.card){
+      native_buf.assign(1, p);
+      const Card &cd = cards[card_pool[nr.offset].x];
+      for (int i = 1; i <= cd.k; i++) native_buf.push_back(~card_pool[nr.offset + i]);
+    } else {
+      RowLiterals(&xor_pool[nr.offset], p, native_buf);
+    }
+    r = NativeClause(native_buf);
+    explained.push_back(make_pair(x, r));
+    return reason[x] = r;
+  }
+
+  void AssignNative(Lit p, bool card, size_t offset){
+    if (DecisionLevel() == 0){
+      Assign(p, CRefUndef);
+      return;
+    }
+    NativeReason nr = { p.Var(), card, offset };
+    native_reasons.push_back(nr);
+    Assign(p, NativeTag + (native_reasons.size() - 1));
+  }
+
+  // the reasons of unassigned variables are at the end
+  void PopNativeReasons(){
+    while (!native_reasons.empty() && assign[native_reasons.back().var] == LUndef){
+      const NativeReason &nr = native_reasons.back();
+      if (nr.card) card_pool.resize(nr.offset);
+      else         xor_pool .resize(nr.offset);
+      native_reasons.pop_back();
+    }
+    // explained in the order of Analyze(), not of the trail
+    size_t j = 0;
+    for (auto &e : explained){
+      if (assign[e.first] == LUndef) arena.Free(e.second);
+      else explained[j++] = e;
+    }
+    explained.resize(j);
+  }
+
+  // the row is unit or false if all the columns but the basic one are counted
+  CRef CheckRow(int r){
+    const uint64_t *row = Row(r);
+    int b = xor_basic[r], parity = xor_rhs[r];
+    for (int w = 0; w < xor_words; w++){
+      uint64_t u = row[w] & ~col_assigned[w];
+      if (w == b >> 6) u &= ~(1ULL << (b & 63));
+      if (u != 0) return CRefUndef;
+      parity ^= __builtin_popcountll(row[w] & col_value[w]) & 1;
+    }
+    Lit p = Lit(col_var[b], !parity);
+    if (Bit(&col_assigned[0], b)){
+      if (parity == 0) return CRefUndef;
+    } else if (Value(p) == LUndef){
+      size_t offset = xor_pool.size();
+      if (DecisionLevel() > 0) xor_pool.insert(xor_pool.end(), row, row + xor_words);
+      AssignNative(p, false, offset);
+      return CRefUndef;
+    } else if (Value(p) == LTrue){
+      return CRefUndef;
+    }
+    RowLiterals(row, Lit(), native_buf);
+    return NativeConflict(native_buf);
+  }
+
+  CRef XorAssigned(int c, bool value){
+    col_assigned[c >> 6] |= 1ULL << (c & 63);
+    if (value) col_value[c >> 6] |= 1ULL << (c & 63);
+    int r = col_row[c];
+    if (r >= 0){
+      // another unassigned column of the row becomes basic
+      uint64_t *row = Row(r);
+      int d = -1;
+      for (int w = 0; w < xor_words && d < 0; w++){
+        uint64_t u = row[w] & ~col_assigned[w];
+        if (u != 0) d = w * 64 + __builtin_ctzll(u);
+      }
+      if (d >= 0){
+        col_row[c]   = -1;
+        col_row[d]   = r;
+        xor_basic[r] = d;
+        for (int r2 = 0; r2 < xor_rows; r2++){
+          if (r2 == r || !Bit(Row(r2), d)) continue;
+          uint64_t *row2 = Row(r2);
+          for (int w = 0; w < xor_words; w++) row2[w] ^= row[w];
+          xor_rhs[r2] ^= xor_rhs[r];
+          row_touched[r2] = true;
+        }
+      }
+    }
+    CRef confl = CRefUndef;
+    for (int r2 = 0; r2 < xor_rows; r2++){
+      if (!row_touched[r2] && !Bit(Row(r2), c)) continue;
+      row_touched[r2] = false;
+      if (confl == CRefUndef) confl = CheckRow(r2);
+    }
+    return confl;
+  }
+
+  // true literals beyond k are a conflict, exactly k make the others false.
+  // p (just counted) is put first so that the conflict has a literal of the
+  // current level
+  CRef CheckCard(int id, Lit p){
+    const Card &cd = cards[id];
+    native_buf.clear();
+    if (p != Lit()) native_buf.push_back(p);
+    for (Lit l : cd.lits) if (l != p && Value(l) == LTrue) native_buf.push_back(l);
+    if ((int)native_buf.size() > cd.k){
+      native_buf.resize(cd.k + 1);
+      for (Lit &l : native_buf) l = ~l;
+      return NativeConflict(native_buf);
+    }
+    if ((int)native_buf.size() < cd.k) return CRefUndef;
+    // the id of the card and its true literals
+    size_t offset = card_pool.size();
+    if (DecisionLevel() > 0){
+      Lit id_lit;
+      id_lit.x = id;
+      card_pool.push_back(id_lit);
+      card_pool.insert(card_pool.end(), native_buf.begin(), native_buf.end());
+    }
+    for (Lit l : cd.lits) if (Value(l) == LUndef) AssignNative(~l, true, offset);
+    return CRefUndef;
+  }
+
+  CRef PropagateNative(Lit p){
+    const vector<int> &occ = card_occ[p.ToInt()];
+    for (int id : occ) cards[id].count++;
+    for (int id : occ){
+      if (cards[id].count < cards[id].k) continue;
+      CRef confl = CheckCard(id, p);
+      if (confl != CRefUndef) return confl;
+    }
+    int c = var_col[p.Var()];
+    return c >= 0 ? XorAssigned(c, !p.Sign()) : CRefUndef;
+  }
+
+  // forget the trail literals from position "to" on
+  void UndoNative(size_t to){
+    for (size_t i = native_head; i-- > to; ){
+      Lit p = trail[i];
+      for (int id : card_occ[p.ToInt()]) cards[id].count--;
+      int c = var_col[p.Var()];
+      if (c >= 0){
+        col_assigned[c >> 6] &= ~(1ULL << (c & 63));
+        col_value   [c >> 6] &= ~(1ULL << (c & 63));
+      }
+    }
+    native_head = to;
+  }
+
+  // native constraints count the literals from the current end of the trail
+  bool EnableNative(){
+    LoadTwoSat();
+    CancelUntil(0);
+    if (Bcp() != CRefUndef) SetUnsat();
+    if (!has_native){
+      has_native  = true;
+      native_head = trail.size();
+    }
+    return ok;
+  }
+
+  // Gauss-Jordan elimination of all the XOR constraints at level 0.
+  // the variables assigned at level 0 are not in the matrix.
+  bool BuildMatrix(){
+    xor_dirty = false;
+    if (!EnableNative()) return false;
+    for (int x : col_var) var_col[x] = -1;
+    col_var.clear();
+    for (auto &xc : xors)
+      for (int x : xc.first)
+        if (assign[x] == LUndef && var_col[x] < 0){
+          var_col[x] = col_var.size();
+          col_var.push_back(x);
+        }
+    int cols  = col_var.size();
+    xor_words = (cols + 63) / 64;
+    xor_rows  = xors.size();
+    matrix .assign((size_t)xor_rows * xor_words, 0);
+    xor_rhs.assign(xor_rows, 0);
+    for (int r = 0; r < xor_rows; r++){
+      xor_rhs[r] = xors[r].second;
+      for (int x : xors[r].first){
+        if (assign[x] != LUndef) xor_rhs[r] ^= assign[x] == LTrue;
+        else Row(r)[var_col[x] >> 6] ^= 1ULL << (var_col[x] & 63);
+      }
+    }
+    col_row  .assign(cols, -1);
+    xor_basic.assign(xor_rows, -1);
+    int rank = 0;
+    for (int c = 0; c < cols && rank < xor_rows; c++){
+      int pivot = rank;
+      while (pivot < xor_rows && !Bit(Row(pivot), c)) pivot++;
+      if (pivot == xor_rows) continue;
+      swap_ranges(Row(pivot), Row(pivot) + xor_words, Row(rank));
+      swap(xor_rhs[pivot], xor_rhs[rank]);
+      for (int r = 0; r < xor_rows; r++){
+        if (r == rank || !Bit(Row(r), c)) continue;
+        for (int w = 0; w < xor_words; w++) Row(r)[w] ^= Row(rank)[w];
+        xor_rhs[r] ^= xor_rhs[rank];
+      }
+      xor_basic[rank] = c;
+      col_row[c]      = rank;
+      rank++;
+    }
+    // the other rows are 0 = rhs
+    for (int r = rank; r < xor_rows; r++) if (xor_rhs[r]) SetUnsat();
+    xor_rows = rank;
+    matrix .resize((size_t)xor_rows * xor_words);
+    xor_rhs.resize(xor_rows);
+    col_assigned.assign(xor_words, 0);
+    col_value   .assign(xor_words, 0);
+    row_touched .assign(xor_rows, false);
+    for (int r = 0; r < xor_rows && ok; r++) if (CheckRow(r) != CRefUndef) SetUnsat();
+    if (ok && Bcp() != CRefUndef) SetUnsat();
+    return ok;
+  }
+
+  static inline Lit IntToLit(int l){ return Lit(abs(l), l < 0); }
+
+  // Solve(vector<clause>) of a 2-CNF without the search. the edges of
+  // (a v b) are ~a -> b and ~b -> a, and ~a -> a for a unit clause.
+  bool SolveTwoSat(const vector<vector<int> > &cs){
+    int max_var = 0;
+    for (auto &c : cs){
+      if (c.empty()){
+        SetUnsat();
+        return false;
+      }
+      for (int l : c) max_var = max(max_var, abs(l));
+    }
+    int V = 2 * (max_var + 1);
+    imp_start.assign(V + 1, 0);
+    for (auto &c : cs){
+      imp_start[(~IntToLit(c[0])).ToInt() + 1]++;
+      if (c.size() == 2) imp_start[(~IntToLit(c[1])).ToInt() + 1]++;
+    }
+    for (int v = 0; v < V; v++) imp_start[v + 1] += imp_start[v];
+    imp_fill.assign(imp_start.begin(), imp_start.end() - 1);
+    imp_adj .resize(imp_start[V]);
+    for (auto &c : cs){
+      Lit a = IntToLit(c[0]), b = IntToLit(c.back());
+      imp_adj[imp_fill[(~a).ToInt()]++] = b.ToInt();
+      if (c.size() == 2) imp_adj[imp_fill[(~b).ToInt()]++] = a.ToInt();
+    }
+    // the literals implied by the unit clauses are true. a formula refuted
+    // by them alone (as CDCL would at level 0) needs no SCC
+    imp_forced.assign(V, false);
+    imp_fill.clear();                    // the queue
+    for (auto &c : cs){
+      int a = IntToLit(c[0]).ToInt();
+      if (c.size() == 1 && !imp_forced[a]){
+        imp_forced[a] = true;
+        imp_fill.push_back(a);
+      }
+    }
+    for (size_t i = 0; i < imp_fill.size(); i++){
+      int u = imp_fill[i];
+      if (imp_forced[u ^ 1]){
+        SetUnsat();
+        return false;
+      }
+      for (int k = imp_start[u]; k < imp_start[u + 1]; k++){
+        int w = imp_adj[k];
+        if (imp_forced[w]) continue;
+        imp_forced[w] = true;
+        imp_fill.push_back(w);
+      }
+    }
+    imp_scc.Build(V, imp_start.data(), imp_adj.data());
+    model.assign(max_var + 1, false);
+    for (int v = 1; v <= max_var; v++){
+      int pos = imp_scc[Lit(v).ToInt()], neg = imp_scc[Lit(v, true).ToInt()];
+      if (pos == neg){                   // x and ~x are equivalent
+        SetUnsat();
+        return false;
+      }
+      model[v] = pos > neg;
+    }
+    two_sat_pending = true;
+    return true;
+  }
+
+  // put the clauses of the implication graph into the solver, once
+  void LoadTwoSat(){
+    if (!two_sat_pending) return;
+    two_sat_pending = false;
+    int V = imp_start.size() - 1;
+    for (int u = 0; u < V; u++){
+      for (int i = imp_start[u]; i < imp_start[u + 1]; i++){
+        Lit a = ~Lit(u >> 1, u & 1), b = Lit(imp_adj[i] >> 1, imp_adj[i] & 1);
+        if (b < a) continue;             // the other edge of the same clause
+        int c[2] = { a.Sign() ? -a.Var() : a.Var(), b.Sign() ? -b.Var() : b.Var() };
+        if (!AddClause(c, c + (a == b ? 1 : 2))) return;
+      }
+    }
+  }
+
+  bool Search(){
+    for(;;){
+      if (terminate != nullptr && terminate->load(memory_order_relaxed)){
+        interrupted = true;
+        return false;
+      }
+      CRef confl = Bcp();
+      if (confl != CRefUndef){
+        stats.conflicts++;
+#if SAT_STATS
+        if (progress_callback && progress_interval > 0 && stats.conflicts % progress_interval == 0)
+          progress_callback(stats);
+#endif
+        if (DecisionLevel() == 0){
+          SetUnsat();
+          return false;
+        }
+        int         bt_level;
+        vector<Lit> learnt;
+        {
+          SAT_TIME(analyze_time);
+          Analyze(confl, learnt, bt_level);
+        }
+        uint32_t lbd = Lbd(learnt.data(), learnt.data() + learnt.size());
+        UpdateRestart(lbd);
+        if (learnt_callback){
+          export_buf.clear();
+          for (Lit q : learnt) export_buf.push_back(q.Sign() ? -q.Var() : q.Var());
+          learnt_callback(export_buf.data(), export_buf.data() + export_buf.size(), lbd);
+        }
+        CancelUntil(bt_level);
+        if (proof != nullptr) LogClause(learnt.data(), learnt.data() + learnt.size(), false);
+        AddClause(learnt, true, lbd);
+        var_inc *= 1 / var_decay;
+        cla_inc *= 1 / 0.999;
+      } else {
+        // inprocessing forces a restart when it is due
+        if (NeedRestart() || (inprocess && stats.conflicts >= next_inprocess)){
+          Restart();
+          if (!ok) return false;
+          continue;
+        }
+        if (DecisionLevel() == 0) Simplify();
+        if (stats.conflicts >= next_reduce){
+          reduce_interval += reduce_inc;
+          next_reduce      = stats.conflicts + reduce_interval;
+          ReduceDB();
+        }
+        SAT_TIME(decide_time);
+        Lit next = Lit();
+        while (DecisionLevel() < (int)assumptions.size()){
+          Lit p = assumptions[DecisionLevel()];
+          if (Value(p) == LTrue){
+            trail_lim.push_back(trail.size());   // dummy level
+          } else if (Value(p) == LFalse){
+            vector<Lit> out;
+            AnalyzeFinal(p, out);
+            for (Lit q : out) conflict.push_back(q.Sign() ? -q.Var() : q.Var());
+            // report the assumptions as given, not their representatives
+            if (num_substituted > 0)
+              for (int &l : conflict)
+                for (int a : assumption_ints) if (ToLit(a) == ToLit(l)){ l = a; break; }
+            return false;
+          } else {
+            next = p;
+            break;
+          }
+        }
+        if (next == Lit()){
+          int x = SelectVariable();
+          if (x == -1){
+            model.assign(n, false);
+            for (int v = 1; v < n; v++) model[v] = (assign[repr[v].Var()] == LTrue) != repr[v].Sign();
+            return true;
+          }
+          next = Lit(x, phase[x]);
+        }
+        SAT_COUNT(decisions);
+        trail_lim.push_back(trail.size());
+        Assign(next, CRefUndef);
+      }
+    }
+  }
+
+  CRef Bcp(){
+    SAT_TIME(bcp_time);
+    CRef confl = CRefUndef;
     while (qhead < trail.size()){
       Lit p = trail[qhead++];
+      stats.propagations++;                 // also the budget of inprocessing
+      if (has_native){
+        confl       = PropagateNative(p);
+        native_head = qhead;
+        if (confl != CRefUndef){
+          qhead = trail.size();
+          break;
+        }
+      }
+      // binary clauses: the blocker is the other literal, no clause access
+      for (const Watcher &w : watch_bin[p.ToInt()]){
+        LBool v = Value(w.blocker);
+        if (v == LTrue) continue;
+        if (v == LFalse){
+          confl = w.cref;
+          break;
+        }
+        Assign(w.blocker, w.cref);
+      }
+      if (confl != CRefUndef){
+        qhead = trail.size();
+        break;
+      }
+
       vector<Watcher> &ws = watch[p.ToInt()];
       size_t i = 0, j = 0;
       for (; i < ws.size(); ){
         
-        if (Value(ws[i].second) == LTrue){ ws[j++] = ws[i++]; continue;}
-        clause &c = *ws[i++].first;
+        if (Value(ws[i].blocker) == LTrue){ ws[j++] = ws[i++]; continue;}
+        CRef    cr = ws[i++].cref;
+        Clause &c  = arena[cr];
         if (c[0] == ~p) swap(c[0], c[1]);
-        Watcher w(&c, c[0]);
+        Watcher w(cr, c[0]);
         if (Value(c[0]) == LTrue){ ws[j++] = w; continue;}
                 
-        for (size_t k = 2; k < c.size(); k++){
-          bcp_count++;
+        for (int k = 2; k < c.size(); k++){
           if (Value(c[k]) != LFalse){
             swap(c[1], c[k]);
             watch[(~c[1]).ToInt()].push_back(w);
@@ -227,11 +1607,11 @@ class SatSolver{
                 
         ws[j++] = w;
         if (Value(c[0]) == LFalse){
-          confl = &c;
+          confl = cr;
           qhead = trail.size();
           while (i < ws.size()) ws[j++] = ws[i++];
         } else
-          Assign(c[0], &c);
+          Assign(c[0], cr);
       NextClause: ;
       }
       ws.resize(j);
@@ -239,32 +1619,190 @@ class SatSolver{
     return confl;
   }
 public:
+  enum RestartPolicy { NO_RESTART, LUBY_RESTART, GLUCOSE_RESTART };
+
   vector<bool>    model;
+  vector<int>     conflict;        // failed assumptions when Solve() == false
+  RestartPolicy   restart_policy;
+  int             luby_unit;
+  bool            preprocess;      // run Preprocessor in Solve(vector<clause>)
+  uint32_t        seed;            // != 0 perturbs the initial activities
+  double          random_var_freq; // probability of a random decision
+  bool            default_phase;   // first value tried for each variable
+  const atomic<bool> *terminate;   // Solve() gives up when it becomes true
+  DratWriter     *proof;           // DRAT proof output (drat.hpp) if not null
+  bool            inprocess;       // simplify the formula during the search
+  uint64_t        inprocess_interval; // conflicts between two inprocessing rounds
+  double          inprocess_effort;   // propagations of a round / of the search
+  bool            two_sat;         // solve a 2-CNF given to Solve(vector<clause>) by SCC
+
+  // called with every learnt clause (as ints) and its LBD
+  function<void(const int*, const int*, uint32_t)> learnt_callback;
+  // called at level 0 after every restart; ImportClause() may be used here
+  function<void()> restart_callback;
+  // called every progress_interval conflicts (unless SAT_STATS == 0)
+  function<void(const SatStats&)> progress_callback;
+  uint64_t         progress_interval;
+
+  SatSolver() : restart_policy(GLUCOSE_RESTART), luby_unit(100), preprocess(false),
+                seed(0), random_var_freq(0), default_phase(false), terminate(nullptr),
+                proof(nullptr), inprocess(true), inprocess_interval(5000), inprocess_effort(0.1),
+                two_sat(true), progress_interval(10000) { Init(); }
+
+  const SatStats &Stats        () const { return stats; }
+  size_t   NumLearnts          () const { return learnts.size(); }
+  uint64_t NumDeletedLearnts   () const { return stats.deleted_learnts; }
+  size_t   ArenaWords          () const { return arena.Size() - arena.wasted; }
+  uint64_t NumConflicts        () const { return stats.conflicts; }
+  uint64_t NumRestarts         () const { return stats.restarts; }
+  uint64_t NumLearntLiterals   () const { return stats.learnt_literals; }
+  uint64_t NumMinimizedLiterals() const { return stats.minimized_literals; }
+  bool     Interrupted         () const { return interrupted; }
+
+  // add a clause derived elsewhere (e.g. by another solver) as a learnt
+  // clause, which may be deleted later. only at level 0.
+  bool ImportClause(const int *begin, const int *end, uint32_t lbd){
+    assert(DecisionLevel() == 0);
+    LoadTwoSat();
+    if (!ok) return false;
+    add_buf.clear();
+    for (const int *l = begin; l != end; l++) add_buf.push_back(ToLit(*l));
+    if (!Normalize(add_buf)) return true;
+    if (add_buf.size() == 0){
+      SetUnsat();
+    } else if (add_buf.size() == 1){
+      Assign(add_buf[0], CRefUndef);
+    } else {
+      CRef cr = arena.Alloc(add_buf.data(), add_buf.size(), true);
+      arena[cr].Lbd() = lbd;
+      learnts.push_back(cr);
+      Attach(cr);
+    }
+    return ok;
+  }
     
+  // add a clause to the current formula; return false if it became unsatisfiable
+  bool AddClause(const int *begin, const int *end){
+    LoadTwoSat();
+    if (!ok) return false;
+    CancelUntil(0);
+    add_buf.clear();
+    for (const int *l = begin; l != end; l++) add_buf.push_back(ToLit(*l));
+    if (!AddClause(add_buf, false) || Bcp() != CRefUndef) SetUnsat();
+    return ok;
+  }
+  bool AddClause(const vector<int> &c){ return AddClause(c.data(), c.data() + c.size()); }
+
+  // the number of true literals in lits is odd if rhs, even otherwise
+  bool AddXor(const vector<int> &lits, bool rhs){
+    if (!EnableNative()) return false;
+    vector<int> vars;
+    for (int l : lits){
+      Lit p = ToLit(l);
+      rhs ^= p.Sign();
+      vars.push_back(p.Var());
+      native_var[p.Var()] = true;
+    }
+    xors.push_back(make_pair(vars, rhs));
+    xor_dirty = true;                    // built by the next Solve()
+    return ok;
+  }
+
+  // at most k of lits are true
+  bool AddAtMost(const vector<int> &lits, int k){
+    if (!EnableNative()) return false;
+    Card cd;
+    cd.k     = k;
+    cd.count = 0;
+    for (int l : lits){
+      Lit p = ToLit(l);
+      native_var[p.Var()] = true;
+      cd.lits.push_back(p);
+      if (Value(p) == LTrue) cd.count++;
+    }
+    int id = cards.size();
+    for (Lit p : cd.lits) card_occ[p.ToInt()].push_back(id);
+    cards.push_back(cd);
+    if (k < 0 || CheckCard(id, Lit()) != CRefUndef || Bcp() != CRefUndef) SetUnsat();
+    return ok;
+  }
+
+  // at least k of lits are true
+  bool AddAtLeast(const vector<int> &lits, int k){
+    vector<int> neg;
+    for (int l : lits) neg.push_back(-l);
+    return AddAtMost(neg, (int)lits.size() - k);
+  }
+
   bool Solve(const vector<vector<int> > &cs){
-    bcp_count = 0;
-    if (!Init(cs)) return false;        
-    for(;;){
-      clause *confl = Bcp();
-      if (confl != nullptr){
-        if (DecisionLevel() == 0) return false; 
-        int         bt_level;
-        vector<Lit> learnt;
-        Analyze(confl, learnt, bt_level);
-        CancelUntil(bt_level);
-        AddClause(learnt, true);
-        var_inc *= 1.01;
-      } else {
-        int next = SelectVariable();
-        if (next == -1){
-          model.resize(n, false);
-          for (int v = 1; v < n; v++) model[v] = assign[v] == LTrue;
-          return true;
-        }
-        trail_lim.push_back(trail.size());
-        Assign(~Lit(next), NULL);
+    Init();
+    if (two_sat && proof == nullptr){
+      bool binary = true;
+      for (auto &c : cs) binary &= c.size() <= 2;
+      if (binary) return SolveTwoSat(cs);
+    }
+    if (!preprocess){
+      for (auto &c : cs) if (!AddClause(c)) return false;
+      return Solve();
+    }
+    Preprocessor         pre;
+    vector<vector<int> > simplified;
+    if (!pre.Run(cs, simplified)) return false;
+    for (auto &c : simplified) if (!AddClause(c)) return false;
+    if (!Solve()) return false;
+    pre.Extend(model);
+    return true;
+  }
+
+  // the number of literals implied by lit when the cube is assumed as in
+  // Solve(cube). -1 on a conflict, -2 if the cube already implies lit.
+  int Lookahead(const vector<int> &cube, int lit){
+    LoadTwoSat();
+    if (!ok || (xor_dirty && !BuildMatrix())) return -1;
+    CancelUntil(0);
+    int res = -1;
+    for (int l : cube){
+      Lit p = ToLit(l);
+      if (Value(p) == LFalse) goto Done;
+      trail_lim.push_back(trail.size());
+      Assign(p, CRefUndef);
+      if (Bcp() != CRefUndef) goto Done;
+    }
+    {
+      Lit    p      = ToLit(lit);
+      size_t before = trail.size();
+      if (Value(p) != LUndef){
+        res = Value(p) == LTrue ? -2 : -1;
+        goto Done;
       }
+      trail_lim.push_back(trail.size());
+      Assign(p, CRefUndef);
+      if (Bcp() == CRefUndef) res = trail.size() - before;
     }
+  Done:
+    CancelUntil(0);
+    return res;
+  }
+
+  // solve the current formula under the assumptions. learnt clauses and
+  // activities are kept for the next call. if the answer is false, conflict
+  // is a subset of the assumptions which can not be true at the same time
+  // (empty when the formula itself is unsatisfiable).
+  bool Solve(const vector<int> &assumps = vector<int>()){
+    conflict.clear();
+    interrupted = false;
+    LoadTwoSat();
+    if (!ok || (xor_dirty && !BuildMatrix())) return false;
+    assumption_ints = assumps;
+    MapAssumptions();
+    // inprocess_interval may have been changed since Init()
+    next_inprocess = min(next_inprocess, stats.conflicts + inprocess_interval);
+#if SAT_STATS
+    SatTimer timer(&stats.solve_time);
+#endif
+    bool res = Search();
+    CancelUntil(0);
+    return res;
   }
 };
 #endif
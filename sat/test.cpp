@@ -8,8 +8,17 @@
 #include <boost/filesystem/path.hpp>
 #include <boost/filesystem/operations.hpp>
 #include <boost/foreach.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/device/file.hpp>
+#include <chrono>
+#include <random>
 
 #include "sat_solver.hpp"
+#include "dimacs.hpp"
+#include "portfolio.hpp"
+#include "cube_and_conquer.hpp"
+#include "drat_checker.hpp"
 using namespace std;
 
 TEST(SMALL_TEST, TEST0){
@@ -60,6 +69,101 @@ void load_file(const string &file, vector<vector<int> > &cs){
     }
 }
 
+vector<vector<int> > parse_file(const string &file){
+    vector<vector<int> > cs;
+    DimacsParser parser;
+    parser.ParseFile(file.c_str(), [&cs](const int *begin, const int *end){
+            cs.push_back(vector<int>(begin, end));
+        });
+    return cs;
+}
+
+TEST(DIMACS_TEST, AIM){
+    namespace fs = boost::filesystem;
+    for (string d : {"./aim_yes", "./aim_no"}){
+        fs::path dir(d);
+        BOOST_FOREACH(const fs::path& p, make_pair(fs::directory_iterator(dir),
+                                                   fs::directory_iterator())) {
+            if (!fs::is_directory(p)){
+                vector<vector<int> > cs;
+                load_file(p.string(), cs);
+                ASSERT_EQ(parse_file(p.string()), cs);
+
+                SatSolver solver;
+                ASSERT_TRUE(LoadDimacs(p.string().c_str(), solver));
+                ASSERT_EQ(solver.Solve(), d == "./aim_yes");
+            }
+        }
+    }
+}
+
+// write a random 3-CNF of about the given size, plain and gzipped
+void write_random_cnf(const string &file, size_t bytes, vector<vector<int> > &cs){
+    mt19937 gen(0);
+    ofstream ofs(file);
+    boost::iostreams::filtering_ostream gz;
+    gz.push(boost::iostreams::gzip_compressor());
+    gz.push(boost::iostreams::file_sink(file + ".gz"));
+    const int n = 1000000;
+    ofs << "c random 3-cnf\np cnf " << n << " 0\n";
+    gz  << "c random 3-cnf\np cnf " << n << " 0\n";
+    while ((size_t)ofs.tellp() < bytes){
+        vector<int> c;
+        ostringstream oss;
+        for (int k = 0; k < 3; k++){
+            int v = gen() % n + 1;
+            c.push_back(gen() % 2 ? v : -v);
+            oss << c.back() << " ";
+        }
+        oss << "0\n";
+        ofs << oss.str();
+        gz  << oss.str();
+        cs.push_back(c);
+    }
+}
+
+TEST(DIMACS_TEST, THROUGHPUT){
+    const string file = "/tmp/procon_library_dimacs_test.cnf";
+    vector<vector<int> > expected;
+    write_random_cnf(file, 32 << 20, expected);
+    double mb = boost::filesystem::file_size(file) / 1048576.0;
+
+    auto start = chrono::steady_clock::now();
+    auto elapsed = [&start](){
+        double s = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        start = chrono::steady_clock::now();
+        return s;
+    };
+    vector<vector<int> > cs;
+    load_file(file, cs);
+    double t_iostream = elapsed();
+
+    size_t clauses = 0, lits = 0;
+    DimacsParser parser;
+    auto count = [&](const int *begin, const int *end){ clauses++; lits += end - begin; };
+    ASSERT_TRUE(parser.ParseFile(file.c_str(), count));
+    double t_mmap = elapsed();
+
+    ifstream ifs(file + ".gz", ios::binary);
+    boost::iostreams::filtering_istream gz;
+    gz.push(boost::iostreams::gzip_decompressor());
+    gz.push(ifs);
+    vector<vector<int> > from_gz;
+    ASSERT_TRUE(parser.ParseStream(gz, [&from_gz](const int *begin, const int *end){
+                from_gz.push_back(vector<int>(begin, end));
+            }));
+    double t_gzip = elapsed();
+
+    ASSERT_EQ(cs, expected);
+    ASSERT_EQ(from_gz, expected);
+    ASSERT_EQ(clauses, expected.size());
+    ASSERT_EQ(lits, 3 * expected.size());
+    cerr << "MB/s (iostream, mmap, gzip stream): "
+         << mb / t_iostream << " " << mb / t_mmap << " " << mb / t_gzip << endl;
+    remove(file.c_str());
+    remove((file + ".gz").c_str());
+}
+
 TEST(AIM_TEST, YES){
     namespace fs = boost::filesystem;
     fs::path dir("./aim_yes");
@@ -91,6 +195,681 @@ TEST(AIM_TEST, NO){
     }
 }
 
+TEST(INCREMENTAL_TEST, ASSUMPTIONS){
+    SatSolver solver;
+    solver.AddClause({-1, 2});
+    solver.AddClause({-2, 3});
+    solver.AddClause({4, 5});
+
+    ASSERT_FALSE(solver.Solve(vector<int>({1, 4, -3})));
+    sort(solver.conflict.begin(), solver.conflict.end());
+    ASSERT_EQ(solver.conflict, vector<int>({-3, 1}));
+
+    ASSERT_TRUE(solver.Solve(vector<int>({1})));
+    ASSERT_TRUE(solver.model[3]);
+
+    ASSERT_TRUE(solver.AddClause({-3}));
+    ASSERT_TRUE(solver.Solve());
+    ASSERT_FALSE(solver.model[1]);
+    ASSERT_FALSE(solver.Solve(vector<int>({5, 1})));
+    ASSERT_EQ(solver.conflict, vector<int>({1}));
+
+    ASSERT_FALSE(solver.AddClause({-4}) && solver.AddClause({-5}));
+    ASSERT_FALSE(solver.Solve());
+    ASSERT_TRUE(solver.conflict.empty());
+}
+
+TEST(INCREMENTAL_TEST, WARM_START){
+    vector<vector<int> > cs;
+    load_file("./aim_yes/aim-200-6_0-yes1-1.cnf", cs);
+    SatSolver solver;
+    ASSERT_TRUE(solver.Solve(cs));
+    vector<bool> model = solver.model;
+    uint64_t cold = solver.NumConflicts();
+    for (int v = 1; v <= 20; v++){
+        ASSERT_TRUE(solver.Solve(vector<int>({model[v] ? v : -v})));
+    }
+    cerr << "conflicts (cold, 20 warm queries): "
+         << cold << " " << solver.NumConflicts() - cold << endl;
+}
+
+uint64_t solve_all(const string &path, bool expected, SatSolver::RestartPolicy policy){
+    namespace fs = boost::filesystem;
+    fs::path dir(path);
+    uint64_t conflicts = 0;
+    BOOST_FOREACH(const fs::path& p, make_pair(fs::directory_iterator(dir),
+                                               fs::directory_iterator())) {
+        if (!fs::is_directory(p)){
+            SatSolver solver;
+            vector<vector<int> > cs;
+            load_file(p.string(), cs);
+            solver.restart_policy = policy;
+            EXPECT_EQ(solver.Solve(cs), expected);
+            conflicts += solver.NumConflicts();
+        }
+    }
+    return conflicts;
+}
+
+TEST(RESTART_TEST, AIM){
+    uint64_t none    = solve_all("./aim_yes", true, SatSolver::NO_RESTART);
+    uint64_t luby    = solve_all("./aim_yes", true, SatSolver::LUBY_RESTART);
+    uint64_t glucose = solve_all("./aim_yes", true, SatSolver::GLUCOSE_RESTART);
+    cerr << "conflicts (none, luby, glucose): "
+         << none << " " << luby << " " << glucose << endl;
+    ASSERT_LE(luby, none);
+    solve_all("./aim_no", false, SatSolver::LUBY_RESTART);
+    solve_all("./aim_no", false, SatSolver::GLUCOSE_RESTART);
+}
+
+TEST(MINIMIZE_TEST, AIM){
+    namespace fs = boost::filesystem;
+    fs::path dir("./aim_no");
+    uint64_t learnt = 0, removed = 0;
+    BOOST_FOREACH(const fs::path& p, make_pair(fs::directory_iterator(dir),
+                                               fs::directory_iterator())) {
+        if (!fs::is_directory(p)){
+            SatSolver solver;
+            vector<vector<int> > cs;
+            load_file(p.string(), cs);
+            ASSERT_FALSE(solver.Solve(cs));
+            learnt  += solver.NumLearntLiterals();
+            removed += solver.NumMinimizedLiterals();
+        }
+    }
+    cerr << "learnt literals: " << learnt << ", removed by minimization: " << removed << endl;
+    ASSERT_GT(removed, 0u);
+}
+
+bool satisfies(const vector<vector<int> > &cs, const vector<bool> &model){
+    for (auto &c : cs){
+        bool sat = false;
+        for (int l : c) if (model[abs(l)] == (l > 0)) sat = true;
+        if (!sat) return false;
+    }
+    return true;
+}
+
+TEST(PREPROCESS_TEST, AIM){
+    namespace fs = boost::filesystem;
+    for (string d : {"./aim_yes", "./aim_no"}){
+        fs::path dir(d);
+        BOOST_FOREACH(const fs::path& p, make_pair(fs::directory_iterator(dir),
+                                                   fs::directory_iterator())) {
+            if (!fs::is_directory(p)){
+                SatSolver solver;
+                vector<vector<int> > cs;
+                load_file(p.string(), cs);
+                solver.preprocess = true;
+                bool res = solver.Solve(cs);
+                ASSERT_EQ(res, d == "./aim_yes");
+                if (res){
+                    ASSERT_TRUE(satisfies(cs, solver.model));
+                }
+            }
+        }
+    }
+}
+
+TEST(PREPROCESS_TEST, RANDOM){
+    for (int t = 0; t < 1000; t++){
+        int n = 5 + t % 10;
+        vector<vector<int> > cs;
+        for (int i = 0; i < 4 * n; i++){
+            vector<int> c;
+            for (int k = rand() % 4; k >= 0; k--) c.push_back((rand() % n + 1) * (rand() % 2 ? 1 : -1));
+            cs.push_back(c);
+        }
+        SatSolver plain, pre;
+        pre.preprocess = true;
+        bool res = plain.Solve(cs);
+        ASSERT_EQ(pre.Solve(cs), res);
+        if (res){
+            ASSERT_TRUE(satisfies(cs, pre.model));
+        }
+    }
+}
+
+// a random 3-CNF over n variables and m more variables, each of which is
+// equivalent to an earlier one or its negation
+vector<vector<int> > random_with_equivalences(int n, int m, int clauses, unsigned seed){
+    mt19937 gen(seed);
+    vector<vector<int> > cs;
+    for (int x = n + 1; x <= n + m; x++){
+        int y = (gen() % (x - 1) + 1) * (gen() % 2 ? 1 : -1);
+        cs.push_back({-x,  y});
+        cs.push_back({ x, -y});
+    }
+    for (int i = 0; i < clauses; i++){
+        vector<int> c;
+        for (int k = 0; k < 3; k++) c.push_back((gen() % (n + m) + 1) * (gen() % 2 ? 1 : -1));
+        cs.push_back(c);
+    }
+    shuffle(cs.begin(), cs.end(), gen);
+    return cs;
+}
+
+TEST(INPROCESS_TEST, EQUIVALENCES){
+    int n = 400, m = 150;
+    vector<vector<int> > cs = random_with_equivalences(n, m, 1300, 8);
+    SatSolver solver;
+    solver.inprocess_interval = 20;
+    ASSERT_TRUE(solver.Solve(cs));
+    ASSERT_TRUE(satisfies(cs, solver.model));
+    ASSERT_GT(solver.Stats().substituted_vars, 0u);
+
+    // substituted variables can still be assumed
+    for (int x = n + 1; x <= n + 20; x++){
+        for (int l : {x, -x}){
+            vector<vector<int> > with = cs;
+            with.push_back({l});
+            SatSolver plain;
+            plain.inprocess = false;
+            bool res = plain.Solve(with);
+            ASSERT_EQ(solver.Solve(vector<int>({l})), res);
+            if (res){
+                ASSERT_TRUE(satisfies(with, solver.model));
+            } else {
+                ASSERT_EQ(solver.conflict, vector<int>({l}));
+            }
+        }
+    }
+    ASSERT_TRUE(solver.AddClause({n + 1, n + 2}));
+    ASSERT_TRUE(solver.AddClause({-(n + 1), n + 3}));
+    cs.push_back({n + 1, n + 2});
+    cs.push_back({-(n + 1), n + 3});
+    ASSERT_TRUE(solver.Solve());
+    ASSERT_TRUE(satisfies(cs, solver.model));
+}
+
+TEST(INPROCESS_TEST, RANDOM){
+    for (int t = 0; t < 1000; t++){
+        int n = 5 + t % 10;
+        vector<vector<int> > cs = random_with_equivalences(n, t % 5, 4 * n, t);
+        SatSolver plain, inproc;
+        plain .inprocess          = false;
+        inproc.inprocess_interval = 1;
+        inproc.restart_policy     = SatSolver::LUBY_RESTART;
+        inproc.luby_unit          = 1;
+        bool res = plain.Solve(cs);
+        ASSERT_EQ(inproc.Solve(cs), res);
+        if (res){
+            ASSERT_TRUE(satisfies(cs, inproc.model));
+        }
+    }
+}
+
+TEST(INPROCESS_TEST, ASSUMPTIONS){
+    // equivalent literals are substituted during Solve(assumps), also
+    // for the variables of the assumptions
+    for (int t = 0; t < 3000; t++){
+        int n = 5 + t % 10;
+        mt19937 gen(t);
+        vector<vector<int> > cs = random_with_equivalences(n, 2 + t % 4, 3 * n, t);
+        vector<int> assumps;
+        for (int k = 0; k <= t % 2; k++) assumps.push_back((gen() % (n + 2) + 1) * (gen() % 2 ? 1 : -1));
+        SatSolver plain, inproc;
+        plain .inprocess          = false;
+        inproc.inprocess_interval = 1;
+        inproc.restart_policy     = SatSolver::LUBY_RESTART;
+        inproc.luby_unit          = 1;
+        for (auto &c : cs){
+            plain .AddClause(c);
+            inproc.AddClause(c);
+        }
+        bool res = plain.Solve(assumps);
+        ASSERT_EQ(inproc.Solve(assumps), res);
+        if (res){
+            ASSERT_TRUE(satisfies(cs, inproc.model));
+            for (int a : assumps) ASSERT_EQ(a > 0, (bool)inproc.model[abs(a)]);
+        }
+    }
+}
+
+TEST(PORTFOLIO_TEST, RING){
+    // the c-th clause has c % 8 + 1 literals, all equal to c + 1: a reader
+    // racing with the writer must never see a mixed clause
+    ClauseRing ring(4, 8);
+    const int C = 2000000;
+    atomic<bool> done(false);
+    thread writer([&](){
+        int lits[8];
+        for (int c = 0; c < C; c++){
+            fill(lits, lits + 8, c + 1);
+            ring.Push(lits, lits + c % 8 + 1);
+        }
+        done = true;
+    });
+    uint64_t cursor = 0, received = 0;
+    vector<int> tmp;
+    bool ok = true;
+    while (!done || received == 0){
+        ring.Read(cursor, tmp, [&](const int *begin, const int *end){
+            int c = *begin - 1;
+            ok &= end - begin == c % 8 + 1;
+            for (const int *l = begin; l != end; l++) ok &= *l == c + 1;
+            received++;
+        });
+    }
+    writer.join();
+    ASSERT_TRUE(ok);
+    ASSERT_GT(received, 0u);
+}
+
+TEST(PORTFOLIO_TEST, AIM){
+    namespace fs = boost::filesystem;
+    double single = 0, portfolio = 0;
+    for (string d : {"./aim_yes", "./aim_no"}){
+        fs::path dir(d);
+        BOOST_FOREACH(const fs::path& p, make_pair(fs::directory_iterator(dir),
+                                                   fs::directory_iterator())) {
+            if (!fs::is_directory(p)){
+                vector<vector<int> > cs;
+                load_file(p.string(), cs);
+                auto start = chrono::steady_clock::now();
+                SatSolver solver;
+                bool expected = solver.Solve(cs);
+                auto mid = chrono::steady_clock::now();
+                PortfolioSolver portfolio_solver(4);
+                bool res = portfolio_solver.Solve(cs);
+                auto end = chrono::steady_clock::now();
+                single    += chrono::duration<double>(mid - start).count();
+                portfolio += chrono::duration<double>(end - mid).count();
+                ASSERT_EQ(res, expected);
+                ASSERT_EQ(res, d == "./aim_yes");
+                if (res){
+                    ASSERT_TRUE(satisfies(cs, portfolio_solver.model));
+                }
+            }
+        }
+    }
+    cerr << "wall-clock seconds (single, portfolio x4): " << single << " " << portfolio << endl;
+}
+
+TEST(PORTFOLIO_TEST, RANDOM_3SAT){
+    // 200 variables at the phase transition
+    mt19937 gen(1);
+    double single = 0, portfolio = 0;
+    for (int t = 0; t < 5; t++){
+        const int n = 200;
+        vector<vector<int> > cs;
+        for (int i = 0; i < n * 426 / 100; i++){
+            vector<int> c;
+            for (int k = 0; k < 3; k++) c.push_back((gen() % n + 1) * (gen() % 2 ? 1 : -1));
+            cs.push_back(c);
+        }
+        auto start = chrono::steady_clock::now();
+        SatSolver solver;
+        bool expected = solver.Solve(cs);
+        auto mid = chrono::steady_clock::now();
+        PortfolioSolver portfolio_solver(4);
+        ASSERT_EQ(portfolio_solver.Solve(cs), expected);
+        auto end = chrono::steady_clock::now();
+        if (expected){
+            ASSERT_TRUE(satisfies(cs, portfolio_solver.model));
+        }
+        single    += chrono::duration<double>(mid - start).count();
+        portfolio += chrono::duration<double>(end - mid).count();
+    }
+    cerr << "wall-clock seconds (single, portfolio x4): " << single << " " << portfolio << endl;
+}
+
+TEST(CUBE_AND_CONQUER_TEST, AIM){
+    namespace fs = boost::filesystem;
+    for (string d : {"./aim_yes", "./aim_no"}){
+        fs::path dir(d);
+        BOOST_FOREACH(const fs::path& p, make_pair(fs::directory_iterator(dir),
+                                                   fs::directory_iterator())) {
+            if (!fs::is_directory(p)){
+                vector<vector<int> > cs;
+                load_file(p.string(), cs);
+                CubeAndConquer solver(4);
+                bool res = solver.Solve(cs);
+                ASSERT_EQ(res, d == "./aim_yes");
+                if (res){
+                    ASSERT_TRUE(satisfies(cs, solver.model));
+                }
+            }
+        }
+    }
+}
+
+TEST(CUBE_AND_CONQUER_TEST, RANDOM_3SAT){
+    mt19937 gen(2);
+    double single = 0, cnc = 0;
+    for (int t = 0; t < 5; t++){
+        const int n = 200;
+        vector<vector<int> > cs;
+        for (int i = 0; i < n * 426 / 100; i++){
+            vector<int> c;
+            for (int k = 0; k < 3; k++) c.push_back((gen() % n + 1) * (gen() % 2 ? 1 : -1));
+            cs.push_back(c);
+        }
+        auto start = chrono::steady_clock::now();
+        SatSolver solver;
+        bool expected = solver.Solve(cs);
+        auto mid = chrono::steady_clock::now();
+        CubeAndConquer cnc_solver(4);
+        ASSERT_EQ(cnc_solver.Solve(cs), expected);
+        auto end = chrono::steady_clock::now();
+        if (expected){
+            ASSERT_TRUE(satisfies(cs, cnc_solver.model));
+        }
+        single += chrono::duration<double>(mid - start).count();
+        cnc    += chrono::duration<double>(end - mid).count();
+    }
+    cerr << "wall-clock seconds (single, cube-and-conquer x4): " << single << " " << cnc << endl;
+}
+
+// p pigeons into p - 1 holes (unsatisfiable, needs many conflicts)
+vector<vector<int> > pigeon_hole(int p){
+    int h = p - 1;
+    vector<vector<int> > cs;
+    for (int i = 0; i < p; i++){
+        vector<int> c;
+        for (int j = 0; j < h; j++) c.push_back(i * h + j + 1);
+        cs.push_back(c);
+    }
+    for (int j = 0; j < h; j++)
+        for (int a = 0; a < p; a++)
+            for (int b = a + 1; b < p; b++)
+                cs.push_back({-(a * h + j + 1), -(b * h + j + 1)});
+    return cs;
+}
+
+TEST(RESTART_TEST, PIGEON_HOLE){
+    // the aim instances are too easy for the glucose restarts to fire.
+    // no inprocessing, which restarts by itself
+    SatSolver glucose, none;
+    glucose.inprocess   = false;
+    none   .inprocess   = false;
+    none.restart_policy = SatSolver::NO_RESTART;
+    ASSERT_FALSE(glucose.Solve(pigeon_hole(9)));
+    ASSERT_FALSE(none.Solve(pigeon_hole(9)));
+    ASSERT_GT(glucose.NumRestarts(), 0u);
+    ASSERT_EQ(none.NumRestarts(), 0u);
+}
+
+TEST(REDUCE_DB_TEST, PIGEON_HOLE){
+    SatSolver solver;
+    ASSERT_FALSE(solver.Solve(pigeon_hole(9)));
+    ASSERT_GT(solver.NumDeletedLearnts(), 0u);
+    ASSERT_LT(solver.NumLearnts(), solver.NumDeletedLearnts());
+}
+
+#if SAT_STATS
+TEST(STATS_TEST, PIGEON_HOLE){
+    SatSolver solver;
+    vector<uint64_t> reported;
+    solver.progress_interval = 500;
+    solver.progress_callback = [&reported](const SatStats &s){ reported.push_back(s.conflicts); };
+    ASSERT_FALSE(solver.Solve(pigeon_hole(8)));
+
+    const SatStats &s = solver.Stats();
+    ASSERT_EQ(s.conflicts, solver.NumConflicts());
+    ASSERT_EQ(s.restarts, solver.NumRestarts());
+    ASSERT_GT(s.decisions, 0u);
+    ASSERT_GT(s.propagations, s.decisions);
+    ASSERT_GT(s.learnt_literals, 0u);
+    ASSERT_GT(s.solve_time, 0.0);
+    ASSERT_EQ(reported.size(), s.conflicts / 500);
+    for (size_t i = 0; i < reported.size(); i++) ASSERT_EQ(reported[i], 500 * (i + 1));
+    cerr << "decisions " << s.decisions << ", propagations " << s.propagations
+         << ", conflicts " << s.conflicts << ", restarts " << s.restarts
+         << ", seconds (solve, bcp, analyze, decide) " << s.solve_time << " "
+         << s.bcp_time << " " << s.analyze_time << " " << s.decide_time << endl;
+}
+#endif
+
+// solve an unsatisfiable formula with a proof and check it
+void check_proof(const vector<vector<int> > &cs, bool binary, uint64_t inprocess_interval = 5000){
+    ostringstream oss;
+    {
+        DratWriter writer(oss, binary, 4096);
+        SatSolver  solver;
+        solver.proof              = &writer;
+        solver.inprocess_interval = inprocess_interval;
+        ASSERT_FALSE(solver.Solve(cs));
+    }
+    DratChecker checker;
+    ASSERT_TRUE(checker.Check(cs, oss.str(), binary));
+    ASSERT_GT(checker.num_lemmas, 0u);
+
+    // a proof without its empty clause is not accepted
+    string proof = oss.str();
+    proof.resize(proof.size() - 2);          // "0\n" or "a\0"
+    ASSERT_FALSE(checker.Check(cs, proof, binary));
+}
+
+TEST(DRAT_TEST, AIM){
+    namespace fs = boost::filesystem;
+    fs::path dir("./aim_no");
+    BOOST_FOREACH(const fs::path& p, make_pair(fs::directory_iterator(dir),
+                                               fs::directory_iterator())) {
+        if (!fs::is_directory(p)){
+            vector<vector<int> > cs = parse_file(p.string());
+            check_proof(cs, false);
+            check_proof(cs, true);
+        }
+    }
+}
+
+TEST(DRAT_TEST, PIGEON_HOLE){
+    // many deletions by ReduceDB
+    check_proof(pigeon_hole(8), false);
+    check_proof(pigeon_hole(8), true);
+}
+
+TEST(DRAT_TEST, INPROCESS){
+    // probing, substitution and vivification at almost every restart
+    for (int p = 6; p <= 8; p++) check_proof(pigeon_hole(p), p % 2, 50);
+    for (int t = 0; t < 200; t++){
+        int n = 5 + t % 10;
+        vector<vector<int> > cs;
+        for (int i = 0; i < 5 * n; i++){
+            vector<int> c;
+            for (int k = rand() % 3; k >= 0; k--) c.push_back((rand() % n + 1) * (rand() % 2 ? 1 : -1));
+            cs.push_back(c);
+        }
+        SatSolver solver;
+        if (!solver.Solve(cs)) check_proof(cs, t % 2, 1);
+    }
+}
+
+vector<vector<int> > random_2cnf(int n, int m){
+    vector<vector<int> > cs;
+    for (int i = 0; i < m; i++){
+        vector<int> c;
+        for (int k = rand() % 5 == 0 ? 1 : 2; k > 0; k--) c.push_back((rand() % n + 1) * (rand() % 2 ? 1 : -1));
+        cs.push_back(c);
+    }
+    return cs;
+}
+
+TEST(TWO_SAT_TEST, RANDOM){
+    for (int t = 0; t < 3000; t++){
+        int n = 2 + t % 30;
+        vector<vector<int> > cs = random_2cnf(n, rand() % (2 * n));
+        SatSolver two_sat, cdcl;
+        cdcl.two_sat = false;
+        bool expected = cdcl.Solve(cs);
+        ASSERT_EQ(two_sat.Solve(cs), expected);
+        if (expected){
+            ASSERT_TRUE(satisfies(cs, two_sat.model));
+        }
+
+        // the incremental API continues from the same formula
+        vector<int> c = {rand() % n + 1, -(rand() % n + 1)};
+        vector<int> as = {(rand() % n + 1) * (rand() % 2 ? 1 : -1)};
+        cs.push_back(c);
+        two_sat.AddClause(c);
+        cdcl   .AddClause(c);
+        expected = cdcl.Solve(as);
+        ASSERT_EQ(two_sat.Solve(as), expected);
+        if (expected){
+            ASSERT_TRUE(satisfies(cs, two_sat.model));
+        }
+    }
+}
+
+TEST(TWO_SAT_TEST, LARGE){
+    // with unit clauses (refuted by them), and without (satisfiable)
+    int n = 500000;
+    for (int units = 1; units >= 0; units--){
+        vector<vector<int> > cs = random_2cnf(n, n * 9 / 10);
+        if (!units) for (auto &c : cs) if (c.size() == 1) c.push_back((rand() % n + 1) * (rand() % 2 ? 1 : -1));
+        SatSolver two_sat, cdcl;
+        cdcl.two_sat = false;
+        auto start = chrono::steady_clock::now();
+        bool expected = cdcl.Solve(cs);
+        auto mid = chrono::steady_clock::now();
+        ASSERT_EQ(two_sat.Solve(cs), expected);
+        auto end = chrono::steady_clock::now();
+        if (expected){
+            ASSERT_TRUE(satisfies(cs, two_sat.model));
+        }
+        cerr << (units ? "with" : "without") << " unit clauses, seconds (cdcl, 2-sat): "
+             << chrono::duration<double>(mid - start).count() << " "
+             << chrono::duration<double>(end - mid).count() << endl;
+    }
+}
+
+// the number of true literals of lits under the model
+int count_true(const vector<int> &lits, const vector<bool> &model){
+    int cnt = 0;
+    for (int l : lits) cnt += model[abs(l)] == (l > 0);
+    return cnt;
+}
+
+TEST(NATIVE_TEST, RANDOM){
+    // clauses, XOR and cardinality constraints against brute force
+    for (int t = 0; t < 2000; t++){
+        int n = 4 + t % 9;
+        SatSolver solver;
+        solver.inprocess_interval = 1 + t % 3 * 20;
+        vector<vector<int> > cs;
+        vector<pair<vector<int>, bool> > xs;
+        vector<pair<vector<int>, int> > ms;      // at most
+        for (int i = rand() % (2 * n); i > 0; i--){
+            vector<int> c;
+            for (int k = rand() % 3; k >= 0; k--) c.push_back((rand() % n + 1) * (rand() % 2 ? 1 : -1));
+            cs.push_back(c);
+            solver.AddClause(c);
+        }
+        for (int i = rand() % 4; i > 0; i--){
+            vector<int> x;
+            for (int k = rand() % n + 1; k > 0; k--) x.push_back((rand() % n + 1) * (rand() % 2 ? 1 : -1));
+            bool rhs = rand() % 2;
+            xs.push_back(make_pair(x, rhs));
+            solver.AddXor(x, rhs);
+        }
+        for (int i = rand() % 4; i > 0; i--){
+            vector<int> perm(n);
+            for (int v = 0; v < n; v++) perm[v] = (v + 1) * (rand() % 2 ? 1 : -1);
+            random_shuffle(perm.begin(), perm.end());
+            perm.resize(rand() % n + 1);
+            int k = rand() % (perm.size() + 1);
+            if (rand() % 2){
+                ms.push_back(make_pair(perm, k));
+                solver.AddAtMost(perm, k);
+            } else {
+                vector<int> neg;
+                for (int l : perm) neg.push_back(-l);
+                ms.push_back(make_pair(neg, (int)perm.size() - k));
+                solver.AddAtLeast(perm, k);
+            }
+        }
+        auto valid = [&](const vector<bool> &model){
+            if (!satisfies(cs, model)) return false;
+            for (auto &x : xs) if (count_true(x.first, model) % 2 != x.second) return false;
+            for (auto &m : ms) if (count_true(m.first, model) > m.second) return false;
+            return true;
+        };
+        // twice with different assumptions
+        for (int a = 0; a < 2; a++){
+            vector<int> as;
+            if (a == 1) as = {rand() % n + 1, -(rand() % n + 1)};
+            bool expected = false;
+            vector<bool> model(n + 1);
+            for (int mask = 0; mask < (1 << n) && !expected; mask++){
+                for (int v = 1; v <= n; v++) model[v] = mask >> (v - 1) & 1;
+                bool ok = true;
+                for (int l : as) ok &= model[abs(l)] == (l > 0);
+                expected = ok && valid(model);
+            }
+            ASSERT_EQ(solver.Solve(as), expected);
+            if (expected){
+                model = solver.model;
+                model.resize(n + 1);
+                ASSERT_TRUE(valid(model));
+                for (int l : as) ASSERT_EQ(model[abs(l)], l > 0);
+            }
+        }
+    }
+}
+
+TEST(NATIVE_TEST, PARITY){
+    // a random linear system over GF(2) with a planted solution is hard as
+    // clauses but is solved by the elimination alone
+    int n = 300;
+    vector<bool> planted(n + 1);
+    for (int v = 1; v <= n; v++) planted[v] = rand() % 2;
+    vector<pair<vector<int>, bool> > xs;
+    for (int i = 0; i < n - 10; i++){
+        vector<int> x;
+        for (int k = 0; k < 5; k++) x.push_back(rand() % n + 1);
+        xs.push_back(make_pair(x, count_true(x, planted) % 2));
+    }
+    SatSolver solver;
+    for (auto &x : xs) solver.AddXor(x.first, x.second);
+    ASSERT_TRUE(solver.Solve());
+    for (auto &x : xs) ASSERT_EQ(count_true(x.first, solver.model) % 2, x.second);
+
+    // the sum of two rows with the opposite parity
+    vector<int> sum = xs[0].first;
+    sum.insert(sum.end(), xs[1].first.begin(), xs[1].first.end());
+    solver.AddXor(sum, !(xs[0].second ^ xs[1].second));
+    ASSERT_FALSE(solver.Solve());
+}
+
+TEST(NATIVE_TEST, QUEENS){
+    // n queens with one cardinality constraint per line instead of O(n^2)
+    // binary clauses each
+    int n = 12;
+    auto var = [n](int r, int c){ return r * n + c + 1; };
+    SatSolver solver;
+    for (int i = 0; i < n; i++){
+        vector<int> row, col;
+        for (int j = 0; j < n; j++){
+            row.push_back(var(i, j));
+            col.push_back(var(j, i));
+        }
+        solver.AddAtLeast(row, 1);
+        solver.AddAtMost(row, 1);
+        solver.AddAtMost(col, 1);
+    }
+    for (int d = -(n - 1); d < n; d++){
+        vector<int> diag, anti;
+        for (int r = 0; r < n; r++){
+            if (0 <= r + d && r + d < n) diag.push_back(var(r, r + d));
+            if (0 <= d + n - 1 - r && d + n - 1 - r < n) anti.push_back(var(r, d + n - 1 - r));
+        }
+        solver.AddAtMost(diag, 1);
+        solver.AddAtMost(anti, 1);
+    }
+    ASSERT_TRUE(solver.Solve());
+    vector<int> cols;
+    for (int r = 0; r < n; r++)
+        for (int c = 0; c < n; c++)
+            if (solver.model[var(r, c)]) cols.push_back(c);
+    ASSERT_EQ(cols.size(), (size_t)n);
+    for (int a = 0; a < n; a++)
+        for (int b = a + 1; b < n; b++){
+            ASSERT_NE(cols[a], cols[b]);
+            ASSERT_NE(abs(cols[a] - cols[b]), b - a);
+        }
+}
+
 TEST(SUDOKU_TEST, YES){
     vector<string> board = {
         "--A----C-----O-I", 